@@ -0,0 +1,108 @@
+#ifndef BEEPER_H
+#define BEEPER_H
+
+#include <Arduino.h>
+#include "chip8_core.h"
+
+// GPIO pin of the passive buzzer or speaker amplifier input
+#ifndef BEEPER_PIN
+  #define BEEPER_PIN 25
+#endif
+
+// Tone frequency in Hz
+#ifndef BEEPER_FREQUENCY
+  #define BEEPER_FREQUENCY 440
+#endif
+
+// Loudness in percent, 100 is a square wave with 50% duty
+#ifndef BEEPER_VOLUME
+  #define BEEPER_VOLUME 50
+#endif
+
+#define BEEPER_RESOLUTION 8  // LEDC duty resolution in bits
+
+/**
+ * @class beeper
+ * @brief CHIP-8 sound output on an LEDC PWM channel.
+ *
+ * begin() attaches the pin to LEDC once, at BEEPER_FREQUENCY with the output silenced.
+ * From then on the LEDC hardware generates the tone by itself: the core's sound callback
+ * only writes the duty when the SOUND flag turns on or off, so nothing runs per sample
+ * or per frame and the emulator loop never polls chip8_core::sound().
+ */
+class beeper {
+  private:
+      chip8_core* core = nullptr;     // Emulator driving the beeper, once bound
+      uint8_t pin = BEEPER_PIN;
+      uint32_t frequency = BEEPER_FREQUENCY;
+      uint8_t volume = BEEPER_VOLUME;
+      bool attached = false;          // The pin is attached to LEDC
+      bool playing = false;           // SOUND is on
+
+      // Duty for the current volume; full volume is half of the period
+      uint32_t duty() const {
+        return (static_cast<uint32_t>(volume) << (BEEPER_RESOLUTION - 1)) / 100;
+      }
+
+      void output(bool on) {
+        playing = on;
+        if (attached) {
+          ledcWrite(pin, on ? duty() : 0);
+        }
+      }
+
+      static void sound_callback(void* arg, bool on) {
+        static_cast<beeper*>(arg)->output(on);
+      }
+
+  public:
+  // Sets up LEDC on 'output_pin' and starts following the SOUND flag of 'instance'; false if LEDC failed
+  bool begin(chip8_core& instance, uint8_t output_pin = BEEPER_PIN) {
+    end();
+    pin = output_pin;
+    if (!ledcAttach(pin, frequency, BEEPER_RESOLUTION)) {
+      return false;
+    }
+    ledcWrite(pin, 0);
+    attached = true;
+    core = &instance;
+    playing = core->sound();
+    output(playing);
+    core->set_sound_callback(&sound_callback, this);
+    return true;
+  }
+
+  // Silences the output and releases the pin
+  void end() {
+    if (core != nullptr) {
+      core->set_sound_callback(nullptr, nullptr);
+      core = nullptr;
+    }
+    if (attached) {
+      ledcWrite(pin, 0);
+      ledcDetach(pin);
+      attached = false;
+    }
+    playing = false;
+  }
+
+  // Changes the tone frequency in Hz
+  void set_frequency(uint32_t hz) {
+    frequency = hz;
+    if (attached) {
+      ledcChangeFrequency(pin, frequency, BEEPER_RESOLUTION);
+      output(playing);
+    }
+  }
+
+  // Changes the loudness in percent (0 mutes)
+  void set_volume(uint8_t percent) {
+    volume = percent > 100 ? 100 : percent;
+    output(playing);
+  }
+
+  uint32_t get_frequency() const { return frequency; }
+  uint8_t get_volume() const { return volume; }
+  bool is_playing() const { return playing; }  // SOUND is on, even if the volume is 0
+};
+#endif
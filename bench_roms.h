@@ -0,0 +1,81 @@
+#ifndef BENCH_ROMS_H
+#define BENCH_ROMS_H
+
+#include "chip8_core.h"
+#include "roms.h"
+
+// Benchmark suite shared by the on-device benchmark (bench_runner.h) and host/chip8_bench:
+// synthetic microbenchmarks that each stress one part of the emulator, then the shipped games.
+// The synthetic ROMs loop forever and never wait for a key or the delay timer, so every
+// instruction of the budget is really executed.
+
+// ALU loop: 8XY0-8XYE, 7XNN and a 5XY0 skip, no display access
+const uint8_t bench_alu[28] = {
+    0x60, 0x01,  // 200: LD V0, 1
+    0x61, 0x03,  // 202: LD V1, 3
+    0x62, 0x07,  // 204: LD V2, 7
+    0x80, 0x14,  // 206: ADD V0, V1
+    0x83, 0x02,  // 208: AND V3, V0
+    0x84, 0x21,  // 20A: OR V4, V2
+    0x85, 0x13,  // 20C: XOR V5, V1
+    0x80, 0x25,  // 20E: SUB V0, V2
+    0x86, 0x26,  // 210: SHR V6, V2
+    0x87, 0x0E,  // 212: SHL V7, V0
+    0x71, 0x05,  // 214: ADD V1, 5
+    0x52, 0x10,  // 216: SE V2, V1
+    0x72, 0x01,  // 218: ADD V2, 1
+    0x12, 0x06,  // 21A: JP 206
+};
+
+// Sprite storm: back-to-back DXYF of a 15-row sprite, moving so it wraps and collides
+const uint8_t bench_sprites[29] = {
+    0xA2, 0x0E,  // 200: LD I, 20E
+    0x60, 0x00,  // 202: LD V0, 0
+    0x61, 0x00,  // 204: LD V1, 0
+    0xD0, 0x1F,  // 206: DRW V0, V1, 15
+    0x70, 0x03,  // 208: ADD V0, 3
+    0x71, 0x05,  // 20A: ADD V1, 5
+    0x12, 0x06,  // 20C: JP 206
+    0x3C, 0x42, 0x81, 0xA5, 0x81, 0x99, 0x42, 0x3C,  // 20E: sprite
+    0xFF, 0x81, 0xBD, 0xA5, 0xBD, 0x81, 0xFF,
+};
+
+// Full clears: 00E0 followed by one font digit, so every frame is a full-screen update
+const uint8_t bench_clear[12] = {
+    0x00, 0xE0,  // 200: CLS
+    0xF0, 0x29,  // 202: LD F, V0
+    0xD1, 0x15,  // 204: DRW V1, V1, 5
+    0x70, 0x01,  // 206: ADD V0, 1
+    0x71, 0x03,  // 208: ADD V1, 3
+    0x12, 0x00,  // 20A: JP 200
+};
+
+// Memory churn: FX55/FX65 of all 16 registers at a moving address in 0x300-0x40F
+const uint8_t bench_memory[14] = {
+    0xA3, 0x00,  // 200: LD I, 300
+    0xF0, 0x1E,  // 202: ADD I, V0
+    0xFF, 0x55,  // 204: LD [I], VF
+    0xFF, 0x65,  // 206: LD VF, [I]
+    0x70, 0x11,  // 208: ADD V0, 11
+    0x81, 0x04,  // 20A: ADD V1, V0
+    0x12, 0x00,  // 20C: JP 200
+};
+
+// One benchmark ROM and the quirk profile it runs with
+struct bench_rom {
+  const char* name;
+  const uint8_t* data;
+  size_t size;
+  chip8_quirk_profile quirks;
+};
+
+static const bench_rom BENCH_ROMS[] = {
+  {"alu", bench_alu, sizeof(bench_alu), CHIP8_QUIRKS_LEGACY},
+  {"sprites", bench_sprites, sizeof(bench_sprites), CHIP8_QUIRKS_LEGACY},
+  {"clear", bench_clear, sizeof(bench_clear), CHIP8_QUIRKS_LEGACY},
+  {"memory", bench_memory, sizeof(bench_memory), CHIP8_QUIRKS_LEGACY},
+  {"space_invaders", space_invaders, sizeof(space_invaders), CHIP8_QUIRKS_LEGACY},
+  {"glitch_ghost", glitch_ghost, sizeof(glitch_ghost), CHIP8_QUIRKS_LEGACY},
+};
+
+#endif  // BENCH_ROMS_H
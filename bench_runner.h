@@ -0,0 +1,154 @@
+#ifndef BENCH_RUNNER_H
+#define BENCH_RUNNER_H
+
+#include "chip8.h"
+#include "bench_roms.h"
+
+#if !CHIP8_PERF
+  #error "bench_runner.h needs the performance counters, build with -DCHIP8_PERF=1"
+#endif
+
+// Instructions executed per ROM, and per emulated frame
+#ifndef BENCH_INSTRUCTIONS
+  #define BENCH_INSTRUCTIONS 300000
+#endif
+#ifndef BENCH_IPF
+  #define BENCH_IPF 1000
+#endif
+
+// Random seed of every run, so games take the same path on every board
+#define BENCH_SEED 0x2545F491
+
+// Time each ROM's result stays on the OLED before the next ROM starts
+#ifndef BENCH_RESULT_MS
+  #define BENCH_RESULT_MS 2000
+#endif
+
+// Measurements of one benchmark ROM
+struct bench_result {
+  uint32_t instructions;     // Instructions executed
+  uint32_t frames;           // Frames emulated
+  uint32_t frames_rendered;  // Frames drawn to the display
+  uint32_t instr_per_s;      // Interpreter throughput, over execution time only
+  uint32_t dxyn_per_s;       // DXYN throughput, over execution time only
+  uint32_t render_us;        // Average time per rendered frame
+  uint32_t i2c_bytes;        // Average I2C bytes per rendered frame
+};
+
+/**
+ * @class bench_runner
+ * @brief Repeatable on-device benchmark over the ROMs of bench_roms.h.
+ *
+ * Every ROM runs for BENCH_INSTRUCTIONS instructions, BENCH_IPF per frame, with the same
+ * random seed and key pattern as host/chip8_bench. Frames are stepped with
+ * chip8_core::step_frame() as fast as the board allows and each published frame is drawn
+ * right away, without frame pacing, so execution and rendering are measured on their own
+ * by the chip8_perf cycle counters. Results are printed as a table and shown on the OLED,
+ * one screen per ROM. Run it from the menu, never during a game: it stops the core.
+ */
+class bench_runner {
+  public:
+    // Runs the whole suite on 'ch8', printing to 'out'; the last result stays on the OLED
+    static void run(chip8& ch8, Print& out) {
+      const size_t count = sizeof(BENCH_ROMS) / sizeof(BENCH_ROMS[0]);
+      out.printf("--- CHIP-8 benchmark: %s %luMHz", ESP.getChipModel(), (unsigned long)ESP.getCpuFreqMHz());
+    #ifdef SSD1306OLED
+      out.printf(", I2C %lukHz", (unsigned long)(Wire.getClock() / 1000));
+    #endif
+      out.printf(", %lu instructions per ROM ---\n", (unsigned long)BENCH_INSTRUCTIONS);
+      out.printf("%-15s %12s %12s %10s %10s %8s\n", "rom", "instr/s", "dxyn/s", "render ms", "i2c B/f", "frames");
+      for (size_t i = 0; i < count; i++) {
+        const bench_rom& rom = BENCH_ROMS[i];
+        bench_result result = run_rom(ch8, rom);
+        out.printf("%-15s %12lu %12lu %6lu.%03lu %10lu %8lu\n", rom.name, (unsigned long)result.instr_per_s,
+                   (unsigned long)result.dxyn_per_s, (unsigned long)(result.render_us / 1000),
+                   (unsigned long)(result.render_us % 1000), (unsigned long)result.i2c_bytes,
+                   (unsigned long)result.frames);
+      #ifdef SSD1306OLED
+        show(ch8, rom, result);
+        if (i + 1 < count) {
+          delay(BENCH_RESULT_MS);
+        }
+      #endif
+      }
+      chip8_perf::getInstance().reset();  // Don't leave benchmark counts in the next game's report
+    }
+
+    // Runs one ROM from a stopped core and measures it
+    static bench_result run_rom(chip8& ch8, const bench_rom& rom) {
+      chip8_core& core = ch8.get_core();
+      chip8_perf& perf = chip8_perf::getInstance();
+      bench_result result = {};
+      core.stop();
+      core.set_quirks(rom.quirks);
+      core.load_rom(rom.data, rom.size);
+      if (!core.start()) {
+        return result;
+      }
+      core.set_random_seed(BENCH_SEED);
+      perf.reset();
+      while (result.instructions < BENCH_INSTRUCTIONS && core.is_running()) {
+        // Hold each key for half a second, cycling through all 16 keys
+        uint16_t key = (result.frames / 60) % 16;
+        core.set_key_mask((result.frames % 60) < 30 ? 1 << key : 0);
+        core.step_frame(BENCH_IPF);
+        if (core.need_to_draw()) {
+        #ifdef SSD1306OLED
+          CHIP8_PERF_BEGIN(render);
+          ch8.get_display().draw();
+          CHIP8_PERF_RENDER_END(render);
+        #else
+          core.get_dirty_map().clear();
+          core.reset_draw();
+        #endif
+        }
+        result.instructions = executed_instructions(perf);
+        result.frames++;
+      }
+      core.stop();
+      core.set_key_mask(0);
+      core.set_random_seed(0);  // Games started later use the hardware RNG again
+
+      uint32_t mhz = ESP.getCpuFreqMHz();
+      if (perf.execute_cycles != 0) {
+        result.instr_per_s = static_cast<uint64_t>(result.instructions) * mhz * 1000000 / perf.execute_cycles;
+        result.dxyn_per_s = static_cast<uint64_t>(perf.dxyn_calls) * mhz * 1000000 / perf.execute_cycles;
+      }
+      result.frames_rendered = perf.frames_rendered;
+      if (perf.frames_rendered != 0) {
+        result.render_us = perf.render_cycles / mhz / perf.frames_rendered;
+        result.i2c_bytes = perf.i2c_bytes / perf.frames_rendered;
+      }
+      return result;
+    }
+
+  private:
+    // Instructions actually executed; idle loops skipped by the core are not counted
+    static uint32_t executed_instructions(const chip8_perf& perf) {
+      uint32_t total = 0;
+      for (uint8_t i = 0; i < 16; i++) {
+        total += perf.opcode_class[i];
+      }
+      return total;
+    }
+
+  #ifdef SSD1306OLED
+    // Shows the result of one ROM on the OLED
+    static void show(chip8& ch8, const bench_rom& rom, const bench_result& result) {
+      Adafruit_SSD1306& oled = ch8.get_display().get_display();
+      oled.clearDisplay();
+      oled.setTextSize(1);
+      oled.setTextColor(SSD1306_WHITE);
+      oled.setCursor(0, 0);
+      oled.println(rom.name);
+      oled.printf("instr/s %lu\n", (unsigned long)result.instr_per_s);
+      oled.printf("dxyn/s  %lu\n", (unsigned long)result.dxyn_per_s);
+      oled.printf("render  %lu.%03lu ms\n", (unsigned long)(result.render_us / 1000), (unsigned long)(result.render_us % 1000));
+      oled.printf("i2c     %lu B/frame\n", (unsigned long)result.i2c_bytes);
+      oled.printf("frames  %lu/%lu\n", (unsigned long)result.frames_rendered, (unsigned long)result.frames);
+      oled.display();
+    }
+  #endif
+};
+
+#endif  // BENCH_RUNNER_H
@@ -6,8 +6,14 @@
 
 #ifdef SSD1306OLED
     #include "ssd1306oled.h"
+    #include "frame_pacer.h"
 #endif
 
+// Render task settings for dual-core mode
+constexpr BaseType_t RENDER_TASK_CORE = 0;         // Core the OLED render task is pinned to
+constexpr UBaseType_t RENDER_TASK_PRIORITY = 1;    // FreeRTOS priority of the render task
+constexpr uint32_t RENDER_TASK_STACK_SIZE = 4096;  // Render task stack size in bytes
+
 /**
  * @class chip8
  * @brief High-level interface for managing the CHIP-8 emulator.
@@ -23,6 +29,29 @@ public:
      */
     typedef void (*emulator_loop_callback)();
 
+    /**
+     * @typedef frame_callback
+     * @brief Receives each rendered frame together with the cells changed since the previous one.
+     *
+     * 'frame' is the 256-byte 64x32 frame, or the 1KB 128x64 frame in SSD1306 page order
+     * if 'hires' is set (see chip8_core::get_display_buffer()).
+     */
+    typedef void (*frame_callback)(void* arg, const uint8_t* frame, bool hires, const dirty_map& dirty);
+
+    /**
+     * @brief Creates the wrapper for an emulator instance.
+     *
+     * The display is bound to the same instance. Several wrappers can run different
+     * instances, but only one of them should render since they share the OLED.
+     *
+     * @param instance Emulator to run (default: chip8_core::getInstance()).
+     */
+    explicit chip8(chip8_core& instance = chip8_core::getInstance()) : core(instance) {
+    #ifdef SSD1306OLED
+        oled.bind(core);
+    #endif
+    }
+
     /**
      * @brief Initializes necessary hardware or peripherals.
      *
@@ -44,39 +73,67 @@ public:
      * This function handles ROM loading, initializes the emulator if needed,
      * and continuously runs the main loop of the emulator.
      *
-     * @param rom Pointer to the ROM data.
+     * @param rom Pointer to the ROM data, or nullptr to start the ROM already loaded into
+     *            the core (e.g. streamed with chip8_core::load_rom() from a rom_catalog).
      * @param rom_size Size of the ROM data in bytes.
      * @param loop_callback Optional user-defined callback function to be executed during each emulator loop.
-     * @param enable_hwt Set to true to enable hardware timers (uses 2 of the 4 ESP32 timers).
+     * @param enable_hwt Set to true to enable hardware timers (uses 1 of the 4 ESP32 timers).
      * @return True if the emulator is running successfully; false otherwise.
      */
     bool play_game(const uint8_t* rom, size_t rom_size, emulator_loop_callback loop_callback = nullptr, bool enable_hwt = false) {
-        if (!chip8_core::getInstance().is_init_and_ready()) {
+        if (!core.is_init_and_ready()) {
             // Load the ROM and initialize the emulator.
-            chip8_core::getInstance().load_rom(rom, rom_size);
+            if (rom != nullptr) {
+                core.load_rom(rom, rom_size);
+            }
 
             // Enable hardware timers if requested.
             if (enable_hwt) {
-                chip8_core::getInstance().enable_hardware_timers();
+                core.enable_hardware_timers();
             }
 
             // Start the emulator; return false if it fails to start.
-            if (!chip8_core::getInstance().start()) {
+            if (!core.start()) {
                 return false;
             }
+            begin_session();
         } else {
             // If the emulator is already running, execute the main loop.
-            if (chip8_core::getInstance().is_running()) {
-                chip8_core::getInstance().loop();
+            if (core.is_running()) {
+                core.loop();
 
             #ifdef SSD1306OLED
-                oled.draw();  ///< Update the OLED display if enabled.
+                if (render_task != nullptr) {
+                    if (core.need_to_draw()) {
+                        xTaskNotifyGive(render_task);  ///< Wake the render task on the other core.
+                    }
+                } else {
+                    render_frame();  ///< Update the OLED display if enabled.
+                }
+            #else
+                if (core.need_to_draw()) {
+                    notify_frame();  ///< No display: the frame callback is the only consumer.
+                    core.get_dirty_map().clear();
+                    core.reset_draw();
+                }
             #endif
 
                 if (loop_callback != nullptr) {
+                    CHIP8_PERF_BEGIN(callback);
                     loop_callback();  ///< Execute the user-defined loop callback, if provided.
+                    CHIP8_PERF_CALLBACK_END(callback);
+                }
+
+                if (sleep_when_idle) {
+                    sleep_until_next_event();
                 }
             } else {
+                core.set_wake_callback(nullptr, nullptr);
+                loop_task = nullptr;
+            #ifdef SSD1306OLED
+                stop_render_task();
+                oled.end_async_flush();
+            #endif
                 return false;  ///< Emulator is not running.
             }
         }
@@ -84,7 +141,171 @@ public:
         return true;  ///< Emulator is running successfully.
     }
 
+    /**
+     * @brief Loads a ROM and continues a game saved with chip8_core::snapshot().
+     *
+     * Replaces the first play_game() call of a session: the saved state is restored instead
+     * of starting the ROM from scratch. Keep calling play_game() with the same ROM afterwards.
+     *
+     * @param saved Snapshot taken while the same ROM was running, e.g. kept in RTC memory.
+     * @param rom Pointer to the ROM data.
+     * @param rom_size Size of the ROM data in bytes.
+     * @param enable_hwt Set to true to enable hardware timers (uses 1 of the 4 ESP32 timers).
+     * @return True if the game was resumed; false if the snapshot was rejected or a game is running.
+     */
+    bool resume_game(const chip8_snapshot& saved, const uint8_t* rom, size_t rom_size, bool enable_hwt = false) {
+        if (core.is_init_and_ready()) {
+            return false;
+        }
+        core.load_rom(rom, rom_size);
+        if (enable_hwt) {
+            core.enable_hardware_timers();
+        }
+        if (!core.restore(saved)) {
+            return false;
+        }
+        begin_session();
+        return true;
+    }
+
+    /**
+     * @brief Selects how many CHIP-8 instructions run per 60Hz frame.
+     *
+     * @param ipf Instructions per frame, or CPU_IPF_LEGACY / CPU_IPF_UNLIMITED.
+     */
+    void set_instructions_per_frame(uint16_t ipf) {
+        core.set_instructions_per_frame(ipf);
+    }
+
+    /**
+     * @brief Runs the game at a multiple of real time, e.g. for attract mode or slow intros.
+     *
+     * Each 60Hz tick then emulates 'multiplier' frames, timers included, but only the last
+     * of them is handed to the display with the changes of the others merged in. Rendering
+     * cost stays that of one frame per tick, so the speed-up is limited by the interpreter,
+     * not by the I2C flush. The multiplier is reported as "speed" by chip8_perf.
+     *
+     * @param multiplier Emulated frames per real frame (1 = real time).
+     */
+    void set_fast_forward(uint8_t multiplier) {
+        core.set_speed_multiplier(multiplier);
+    }
+
+    /**
+     * @brief Returns the current fast-forward multiplier, 1 for real time.
+     */
+    uint8_t get_fast_forward() {
+        return core.get_speed_multiplier();
+    }
+
+    /**
+     * @brief Retrieves the emulator instance this wrapper runs.
+     *
+     * @return Reference to the `chip8_core` instance.
+     */
+    chip8_core& get_core() {
+        return core;
+    }
+
+    /**
+     * @brief Sets the function that receives every rendered frame, e.g. frame_streamer::on_frame.
+     *
+     * The callback runs where frames are rendered (the render task in dual-core mode) right
+     * before the display consumes the dirty map, so it must only copy what it needs. Set it
+     * before a game starts. Frames skipped by the pacer are merged into the next one it receives.
+     *
+     * @param callback Function to call, or nullptr to disable it.
+     * @param arg Argument passed to the callback.
+     */
+    void set_frame_callback(frame_callback callback, void* arg) {
+        frame_arg = arg;
+        on_frame = callback;
+    }
+
+    /**
+     * @brief Enables or disables sleeping while the game is idle.
+     *
+     * When enabled, play_game() blocks the loop task while the ROM waits in FX0A or
+     * spins on the delay timer, until the next 60Hz tick or a key press, instead of
+     * busy-polling. The CPU then runs the FreeRTOS idle task, which enters light sleep
+     * if power management with tickless idle is enabled. Takes effect on the next
+     * play_game() start.
+     *
+     * @param enable True to sleep while idle.
+     */
+    void set_sleep_when_idle(bool enable) {
+        sleep_when_idle = enable;
+    }
+
 #ifdef SSD1306OLED
+    /**
+     * @brief Enables or disables dual-core rendering.
+     *
+     * When enabled, the next game start creates a FreeRTOS task pinned to RENDER_TASK_CORE
+     * that renders published frames, so blocking I2C transfers no longer stall the
+     * interpreter running in the Arduino loop task. Takes effect on the next play_game() start.
+     *
+     * @param enable True to render on a separate core.
+     */
+    void set_dual_core(bool enable) {
+        dual_core = enable;
+    }
+
+    /**
+     * @brief Enables or disables asynchronous display flushing.
+     *
+     * When enabled, frames are converted in the emulator loop and a background task sends
+     * a snapshot of the page buffer over I2C, so instruction execution continues during
+     * the transfer. Takes effect on the next play_game() start.
+     *
+     * @param enable True to flush the display asynchronously.
+     */
+    void set_async_flush(bool enable) {
+        async_flush = enable;
+    }
+
+    /**
+     * @brief Checks whether the last display flush has completed.
+     *
+     * @return True if no asynchronous transfer is in flight.
+     */
+    bool display_flush_done() {
+        return oled.flush_done();
+    }
+
+    /**
+     * @brief Sets the target render rate; published frames arriving faster are skipped.
+     *
+     * Skipped frames never affect emulation: their changes are merged into the next
+     * rendered frame and the 60Hz timers keep running independently.
+     *
+     * @param fps Target frames per second (default 60, 0 for no rate limit).
+     */
+    void set_render_rate(uint8_t fps) {
+        pacer.set_target_rate(fps);
+    }
+
+    /**
+     * @brief Sets the share of wall time rendering may take before frames are skipped.
+     *
+     * The measured render latency divided by this budget is used as the minimum
+     * interval between renders, so a slow display gets fewer frames automatically.
+     *
+     * @param percent Render budget in percent (default 50, 100 disables latency feedback).
+     */
+    void set_render_budget(uint8_t percent) {
+        pacer.set_budget(percent);
+    }
+
+    /**
+     * @brief Retrieves the frame pacer for render latency and skip statistics.
+     *
+     * @return Reference to the `frame_pacer` instance.
+     */
+    const frame_pacer& get_frame_pacer() const {
+        return pacer;
+    }
+
     /**
      * @brief Retrieves the OLED display instance for external use.
      *
@@ -99,8 +320,151 @@ public:
 #endif
 
 private:
+    chip8_core& core;                    ///< Emulator instance run by this wrapper.
+    bool sleep_when_idle = false;        ///< Sleep while the game is idle when the next game starts.
+    TaskHandle_t loop_task = nullptr;    ///< Task running play_game(), woken by key presses.
+    frame_callback on_frame = nullptr;   ///< Receives each rendered frame, if set.
+    void* frame_arg = nullptr;           ///< Argument passed to on_frame.
+
+    /**
+     * @brief Hands the published frame to the frame callback, if one is set.
+     */
+    void notify_frame() {
+        if (on_frame != nullptr) {
+            on_frame(frame_arg, core.get_display_buffer(), core.is_hires(), core.get_dirty_map());
+        }
+    }
+
+    /**
+     * @brief Sets up idle wake-ups, frame pacing and rendering for a game that just started.
+     */
+    void begin_session() {
+        if (sleep_when_idle) {
+            loop_task = xTaskGetCurrentTaskHandle();
+            core.set_wake_callback(wake_loop_task, this);
+        }
+
+    #ifdef SSD1306OLED
+        pacer.reset();
+        if (async_flush) {
+            oled.begin_async_flush();
+        }
+        if (dual_core) {
+            start_render_task();
+        }
+    #endif
+    }
+
+    /**
+     * @brief Wake callback of the core: ends a sleep in sleep_until_next_event().
+     *
+     * @param arg Pointer to the owning chip8 instance.
+     */
+    static void wake_loop_task(void* arg) {
+        TaskHandle_t task = static_cast<chip8*>(arg)->loop_task;
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+
+    /**
+     * @brief Sleeps until the next 60Hz tick or key press if the game is idle.
+     *
+     * Waits in whole FreeRTOS ticks and never past the next 60Hz tick, so emulation
+     * timing is unaffected.
+     */
+    void sleep_until_next_event() {
+        TickType_t ticks = pdMS_TO_TICKS(core.idle_time_us() / 1000);
+        if (ticks > 0) {
+            ulTaskNotifyTake(pdTRUE, ticks);
+        }
+    }
+
 #ifdef SSD1306OLED
     ssd1306oled oled;  ///< Instance of the OLED display handler.
+    frame_pacer pacer; ///< Decides which published frames are rendered.
+
+    bool dual_core = false;                   ///< Render on a separate core when the next game starts.
+    bool async_flush = false;                 ///< Flush the display from a background task when the next game starts.
+    TaskHandle_t render_task = nullptr;       ///< Handle of the running render task, if any.
+    std::atomic<bool> render_task_active{false};  ///< Cleared to ask the render task to exit.
+    std::atomic<bool> render_task_exited{false};  ///< Set by the render task right before it exits.
+
+    /**
+     * @brief Renders the published frame, or skips it if the pacer says it is too early.
+     *
+     * Called from the emulator loop, or from the render task in dual-core mode.
+     */
+    void render_frame() {
+        if (core.need_to_draw()) {
+            uint32_t start = micros();
+            if (!pacer.should_render(start)) {
+                core.skip_frame();  ///< Merge this frame into the next one.
+                return;
+            }
+            CHIP8_PERF_BEGIN(render);
+            notify_frame();
+            oled.draw();
+            CHIP8_PERF_RENDER_END(render);
+            pacer.rendered_frame(start, micros());
+        } else {
+            oled.draw();  ///< Lets async flushing hand over converted frames once the bus is free.
+        }
+    }
+
+    /**
+     * @brief Render task body: draws each published frame until asked to exit.
+     *
+     * The task sleeps until the emulator loop notifies it of a published frame, with a
+     * one-frame timeout so an exit request is never missed.
+     *
+     * @param arg Pointer to the owning chip8 instance.
+     */
+    static void render_task_main(void* arg) {
+        chip8* self = static_cast<chip8*>(arg);
+        while (self->render_task_active.load(std::memory_order_acquire)) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GPU_TIMER_INTERVAL));
+            self->render_frame();
+        }
+        self->render_task_exited.store(true, std::memory_order_release);
+        vTaskDelete(NULL);
+    }
+
+    /**
+     * @brief Creates the render task pinned to RENDER_TASK_CORE.
+     *
+     * Falls back to rendering from the loop task if the task cannot be created.
+     */
+    void start_render_task() {
+        if (render_task != nullptr) {
+            return;
+        }
+        render_task_exited.store(false, std::memory_order_relaxed);
+        render_task_active.store(true, std::memory_order_release);
+        if (xTaskCreatePinnedToCore(render_task_main, "chip8_render", RENDER_TASK_STACK_SIZE, this,
+                                    RENDER_TASK_PRIORITY, &render_task, RENDER_TASK_CORE) != pdPASS) {
+            render_task_active.store(false, std::memory_order_relaxed);
+            render_task = nullptr;
+        }
+    }
+
+    /**
+     * @brief Asks the render task to exit and waits until it has finished its last frame.
+     *
+     * Waiting instead of deleting the task keeps a transfer in progress from being cut off
+     * while it holds the I2C bus, so the menu can safely use the display afterwards.
+     */
+    void stop_render_task() {
+        if (render_task == nullptr) {
+            return;
+        }
+        render_task_active.store(false, std::memory_order_release);
+        xTaskNotifyGive(render_task);
+        while (!render_task_exited.load(std::memory_order_acquire)) {
+            vTaskDelay(1);
+        }
+        render_task = nullptr;
+    }
 #endif
 };
 
@@ -1,16 +1,5 @@
 #include "chip8_core.h"
 
-// Hardware timer instances
-hw_timer_t* timer0 = NULL;
-hw_timer_t* timer1 = NULL;
-
-// Mutex for timer synchronization
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
-
-// Atomic flags for timer interrupts
-std::atomic<bool> timer0_flag = false;
-std::atomic<bool> timer1_flag = false;
-
 // Define various emulator state flags for tracking different statuses
 #define HARDWARE_TIMERS       0   ///< Flag indicating if hardware timers are enabled
 #define ROM_IS_LOADED         1   ///< Flag indicating if a ROM has been loaded
@@ -22,10 +11,10 @@ std::atomic<bool> timer1_flag = false;
 #define PAUSE                 7   ///< Flag indicating if the emulator is paused
 
 /**
- * @brief CHIP-8 font set loaded into emulator memory.
+ * @brief CHIP-8 font set loaded into emulator memory at address 0x50 (see FX29).
  * Each character is represented as a 4x5 pixel sprite.
  */
-uint16_t FONTSET[80] = {
+constexpr uint8_t FONTSET[80] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
     0x20, 0x60, 0x20, 0x20, 0x70, // 1
     0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
@@ -44,90 +33,208 @@ uint16_t FONTSET[80] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
+/**
+ * @brief SUPER-CHIP font set loaded at address 0xA0 (see FX30).
+ * Each digit 0-9 is an 8x10 pixel sprite.
+ */
+constexpr uint8_t BIG_FONTSET[100] = {
+    0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, // 0
+    0x18, 0x38, 0x58, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3C, // 1
+    0x3E, 0x7F, 0xC3, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFF, 0xFF, // 2
+    0x3C, 0x7E, 0xC3, 0x03, 0x0E, 0x0E, 0x03, 0xC3, 0x7E, 0x3C, // 3
+    0x06, 0x0E, 0x1E, 0x36, 0x66, 0xC6, 0xFF, 0xFF, 0x06, 0x06, // 4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFE, 0x03, 0xC3, 0x7E, 0x3C, // 5
+    0x3E, 0x7C, 0xC0, 0xC0, 0xFC, 0xFE, 0xC3, 0xC3, 0x7E, 0x3C, // 6
+    0xFF, 0xFF, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, // 7
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7E, 0x7E, 0xC3, 0xC3, 0x7E, 0x3C, // 8
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7F, 0x3F, 0x03, 0x03, 0x3E, 0x7C  // 9
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if CHIP8_FLASH_ROM
+/**
+ * @brief Backing of memory pages that hold nothing but zeros.
+ */
+static const uint8_t ZERO_PAGE[256] = {0};
+#endif
+
 /**
  * @brief Loads a ROM into the emulator's RAM starting at address 0x200.
  *
- * This function clears the RAM, loads the default font set, and copies the ROM data into memory.
+ * This function clears the RAM, loads the default font set, copies the ROM data into memory
+ * and predecodes the program area.
+ *
+ * With CHIP8_FLASH_ROM the ROM is not copied: whole 256-byte pages of it are mapped in
+ * place, so it must stay valid until the next load_rom(). Only page 0 (the font) and a
+ * partial last page get RAM copies; every other page is copied when first written.
  *
  * @param rom Pointer to the ROM data.
- * @param rom_size Size of the ROM data in bytes.
+ * @param rom_size Size of the ROM data in bytes (at most 3584; excess is ignored).
  */
 void chip8_core::load_rom(const uint8_t* rom, const size_t rom_size) {
-  
-    //Clears the RAM before loading a ROM
-    memset(RAM, 0, sizeof(RAM));
-
-    // Load the default font set into RAM
-    load_fontset();
+    size_t size = min(rom_size, static_cast<size_t>(4096 - 0x200));
+    clear_memory();
 
+#if CHIP8_FLASH_ROM
+    // Map the ROM's whole pages in place and copy the partial last page
+    const uint8_t first_page = 0x200 / RAM_PAGE_SIZE;
+    size_t whole_pages = size / RAM_PAGE_SIZE;
+    for (size_t i = 0; i < whole_pages; i++) {
+        read_pages[first_page + i] = rom + i * RAM_PAGE_SIZE;
+    }
+    size_t tail = size % RAM_PAGE_SIZE;
+    if (tail != 0) {
+        memcpy(copy_page(first_page + whole_pages), rom + whole_pages * RAM_PAGE_SIZE, tail);
+    }
+#else
     // Copy ROM data to memory starting at address 0x200
-    memcpy(RAM + 0x200, rom, rom_size);
+    memcpy(RAM + 0x200, rom, size);
+#endif
+
+    // Translate the program area into the predecode cache
+    predecode_all();
 
     // Set the flag indicating that a ROM has been loaded
     flag.set(ROM_IS_LOADED, true);
 }
 
 /**
- * @brief Interrupt Service Routine for Timer0.
+ * @brief Streams a ROM into the emulator's RAM starting at address 0x200.
+ *
+ * Like load_rom(const uint8_t*, size_t), but the ROM is pulled from 'reader' straight
+ * into emulator memory, so it can come from a file without an intermediate buffer.
+ * With CHIP8_FLASH_ROM every page of the ROM gets a RAM copy from the page pool.
+ *
+ * @param reader Function reading the next part of the ROM.
+ * @param arg Argument passed to 'reader', e.g. an open file.
+ * @param rom_size Size of the ROM data in bytes (at most 3584; excess is not read).
+ * @return True if the ROM was loaded; false if the reader ended early or (CHIP8_FLASH_ROM)
+ *         the page pool is too small for the ROM.
+ */
+bool chip8_core::load_rom(chip8_rom_reader reader, void* arg, size_t rom_size) {
+    size_t size = min(rom_size, static_cast<size_t>(4096 - 0x200));
+    flag.set(ROM_IS_LOADED, false);
+    clear_memory();
+
+    size_t loaded = 0;
+    while (loaded < size) {
+        uint16_t address = 0x200 + loaded;
+#if CHIP8_FLASH_ROM
+        uint8_t page = address / RAM_PAGE_SIZE;
+        uint8_t* copy = write_pages[page] != nullptr ? write_pages[page] : copy_page(page);
+        if (copy == nullptr) {
+            return false;
+        }
+        uint8_t* destination = copy + address % RAM_PAGE_SIZE;
+        size_t length = min(size - loaded, static_cast<size_t>(RAM_PAGE_SIZE - address % RAM_PAGE_SIZE));
+#else
+        uint8_t* destination = RAM + address;
+        size_t length = size - loaded;
+#endif
+        size_t read = reader(arg, destination, length);
+        if (read == 0) {
+            return false; // The ROM ended early
+        }
+        loaded += read;
+    }
+
+    predecode_all();
+    flag.set(ROM_IS_LOADED, true);
+    return true;
+}
+
+/**
+ * @brief Clears the emulator memory and loads the font set.
  *
- * Sets the timer0_flag to true when the timer interrupt occurs.
+ * With CHIP8_FLASH_ROM every page is mapped to zeros and only pages 0 and 1 (the fonts)
+ * get RAM copies.
  */
-void IRAM_ATTR onTimer0() {
-    timer0_flag.store(true, std::memory_order_relaxed);
+void chip8_core::clear_memory() {
+#if CHIP8_FLASH_ROM
+    ram_pages_used = 0;
+    for (uint8_t page = 0; page < MEMORY_PAGES; page++) {
+        read_pages[page] = ZERO_PAGE;
+        write_pages[page] = nullptr;
+    }
+    copy_page(0);
+    copy_page(1); // The end of the big font
+#else
+    //Clears the RAM before loading a ROM
+    memset(RAM, 0, sizeof(RAM));
+#endif
+
+    // Load the default font set into RAM
+    load_fontset();
 }
 
 /**
- * @brief Interrupt Service Routine for Timer1.
+ * @brief Interrupt Service Routine of the hardware timer.
+ *
+ * Fires every CPU_TIMER_INTERVAL and counts one CPU slice. The elapsed time is also
+ * accumulated in units of 1/60 microsecond, so a 60Hz tick is counted every exact
+ * 1/60 second (8 or 9 interrupts) without drift. Counting instead of setting a flag
+ * means no slice or tick is lost when loop() is late.
  *
- * Sets the timer1_flag to true when the timer interrupt occurs.
+ * @param arg The chip8_core instance the timer belongs to.
  */
-void IRAM_ATTR onTimer1() {
-    timer1_flag.store(true, std::memory_order_relaxed);
+void IRAM_ATTR chip8_core::on_timer(void* arg) {
+    chip8_core* core = static_cast<chip8_core*>(arg);
+    core->cpu_ticks.fetch_add(1, std::memory_order_relaxed);
+    core->frame_accumulator += CPU_TIMER_INTERVAL * 1000 * 60;
+    if (core->frame_accumulator >= 1000000) {
+        core->frame_accumulator -= 1000000;
+        core->gpu_ticks.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 /**
- * @brief Loads the font set into emulator RAM at address 0x50.
+ * @brief Loads the font sets into emulator RAM at addresses 0x50 and 0xA0.
  *
- * This function copies the predefined FONTSET array into the emulator's RAM.
+ * This function copies the predefined FONTSET array and the SCHIP BIG_FONTSET into the
+ * emulator's RAM.
  */
 void chip8_core::load_fontset() {
+#if CHIP8_FLASH_ROM
+    memcpy(write_pages[0] + 0x50, FONTSET, sizeof(FONTSET));
+    memcpy(write_pages[0] + 0xA0, BIG_FONTSET, 0x100 - 0xA0);
+    memcpy(write_pages[1], BIG_FONTSET + (0x100 - 0xA0), sizeof(BIG_FONTSET) - (0x100 - 0xA0));
+#else
     memcpy(RAM + 0x50, FONTSET, sizeof(FONTSET));
+    memcpy(RAM + 0xA0, BIG_FONTSET, sizeof(BIG_FONTSET));
+#endif
 }
 
 /**
- * @brief Starts the hardware timers for CPU and GPU cycles.
+ * @brief Starts the hardware timer driving CPU and GPU cycles.
  *
- * Initializes and configures Timer0 and Timer1 with specified intervals.
+ * Allocates one timer for this instance with the CPU interval; its interrupt derives
+ * the 60Hz ticks as well and only touches this instance's counters.
  */
 void chip8_core::ht_start() {
-    timer0 = timerBegin(1000000);
-    timerAttachInterrupt(timer0, &onTimer0);
-    timerAlarm(timer0, 2000, true, 0);
-
-    timer1 = timerBegin(1000000);
-    timerAttachInterrupt(timer1, &onTimer1);
-    timerAlarm(timer1, 16667, true, 0);
+    cpu_ticks.store(0, std::memory_order_relaxed);
+    gpu_ticks.store(0, std::memory_order_relaxed);
+    frame_accumulator = 0;
+    hw_timer = timerBegin(1000000);
+    if (hw_timer != NULL) {
+        timerAttachInterruptArg(hw_timer, &on_timer, this);
+        timerAlarm(hw_timer, CPU_TIMER_INTERVAL * 1000, true, 0);
+    }
 }
 
 /**
- * @brief Stops the hardware timers for CPU and GPU cycles.
+ * @brief Stops the hardware timer.
  *
- * Disables and deinitializes Timer0 and Timer1, and resets the timer flags.
+ * Disables and deinitializes this instance's timer, and resets the tick counters.
  */
 void chip8_core::ht_stop() {
-    if (timer0 != NULL) {
-        timerEnd(timer0);
-        timer0 = NULL;
-    }
-    if (timer1 != NULL) {
-        timerEnd(timer1);
-        timer1 = NULL;
+    if (hw_timer != NULL) {
+        timerEnd(hw_timer);
+        hw_timer = NULL;
     }
-    timer0_flag.store(false, std::memory_order_relaxed);
-    timer1_flag.store(false, std::memory_order_relaxed);
+    cpu_ticks.store(0, std::memory_order_relaxed);
+    gpu_ticks.store(0, std::memory_order_relaxed);
 }
 
 /**
@@ -140,39 +247,75 @@ void chip8_core::enable_hardware_timers() {
 }
 
 /**
- * @brief Checks if the CPU timer flag is set.
+ * @brief Selects how many instructions are executed per 60Hz frame.
+ *
+ * CPU_IPF_LEGACY executes one instruction every CPU_TIMER_INTERVAL, CPU_IPF_UNLIMITED
+ * executes CPU_BATCH_SIZE instructions on every loop() call, and any other value runs
+ * that many instructions in one tight batch at each frame boundary (8-30 suits most ROMs).
+ *
+ * @param ipf Instructions per frame or one of the CPU_IPF_* presets.
+ */
+void chip8_core::set_instructions_per_frame(uint16_t ipf) {
+    instructions_per_frame = ipf;
+}
+
+/**
+ * @brief Returns the current instructions-per-frame setting.
  *
- * @return True if Timer0 has triggered; otherwise, false.
+ * @return Instructions per frame or one of the CPU_IPF_* presets.
  */
-bool chip8_core::cpu_timer_flag() {
-    return timer0_flag.load(std::memory_order_relaxed);
+uint16_t chip8_core::get_instructions_per_frame() {
+    return instructions_per_frame;
 }
 
 /**
- * @brief Resets the CPU timer flag.
+ * @brief Runs the emulation at a multiple of real time, e.g. to skip slow intros.
  *
- * Clears the Timer0 flag after it has been handled.
+ * Every elapsed 60Hz tick then emulates 'multiplier' complete frames: each with its own
+ * instruction batch and delay/sound timer tick, so the ROM sees an ordinary machine. Only
+ * the last of them is published, with the changes of the others merged in, so the display
+ * keeps drawing at most 60 frames per second and the speed-up is bounded by interpreter
+ * throughput rather than by the display. In CPU_IPF_LEGACY mode each CPU slice runs
+ * 'multiplier' instructions; in CPU_IPF_UNLIMITED mode only the timers speed up.
+ *
+ * @param multiplier Emulated frames per real frame; 1 (or 0) is real time.
+ */
+void chip8_core::set_speed_multiplier(uint8_t multiplier) {
+    speed_multiplier = multiplier > 1 ? multiplier : 1;
+    CHIP8_PERF_SET(multiplier, speed_multiplier);
+}
+
+/**
+ * @brief Returns the current speed multiplier.
+ *
+ * @return Emulated frames per real 60Hz tick, 1 for real time.
  */
-void chip8_core::reset_cpu_timer_flag() {
-    timer0_flag.store(false, std::memory_order_relaxed);
+uint8_t chip8_core::get_speed_multiplier() {
+    return speed_multiplier;
 }
 
 /**
- * @brief Checks if the GPU timer flag is set.
+ * @brief Takes the CPU slices counted by the timer interrupt.
  *
- * @return True if Timer1 has triggered; otherwise, false.
+ * @return Number of CPU_TIMER_INTERVAL slices elapsed since the last call.
  */
-bool chip8_core::gpu_timer_flag() {
-    return timer1_flag.load(std::memory_order_relaxed);
+uint32_t CHIP8_HOT chip8_core::take_cpu_ticks() {
+    if (cpu_ticks.load(std::memory_order_relaxed) == 0) {
+        return 0; // Common case, no atomic read-modify-write needed
+    }
+    return cpu_ticks.exchange(0, std::memory_order_relaxed);
 }
 
 /**
- * @brief Resets the GPU timer flag.
+ * @brief Takes the 60Hz ticks counted by the timer interrupt.
  *
- * Clears the Timer1 flag after it has been handled.
+ * @return Number of 60Hz ticks elapsed since the last call.
  */
-void chip8_core::reset_gpu_timer_flag() {
-    timer1_flag.store(false, std::memory_order_relaxed);
+uint32_t CHIP8_HOT chip8_core::take_gpu_ticks() {
+    if (gpu_ticks.load(std::memory_order_relaxed) == 0) {
+        return 0;
+    }
+    return gpu_ticks.exchange(0, std::memory_order_relaxed);
 }
 
 /**
@@ -190,12 +333,16 @@ void chip8_core::initialize() {
     reg.DELAYTIMER = 0; // Clear delay timer
     reg.SOUNDTIMER = 0; // Clear sound timer
     memset(reg.V, 0, sizeof(reg.V)); // Clear all general-purpose registers V0-VF
-    memset(DISPLAYBUFFER, 0, sizeof(DISPLAYBUFFER));
-    memset(dirty_flags, 1, sizeof(dirty_flags));
+    hires = false;  // Every ROM starts in 64x32 mode
+    memset(HIRES_DISPLAYBUFFER, 0, sizeof(HIRES_DISPLAYBUFFER));
+    dirty.mark_all();
+    frame_hires = false;
+    memset(HIRES_FRAMEBUFFER, 0, sizeof(HIRES_FRAMEBUFFER));
+    frame_dirty.clear();
 
     // Reset the timing for CPU and GPU cycles
     last_CPU_cycle = 0;
-    last_GPU_cycle = 0;
+    last_GPU_cycle = micros();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -222,12 +369,8 @@ bool chip8_core::start() {
     bool rom_is_loaded = flag.get(ROM_IS_LOADED);
     bool state = flag.get(EMULATOR_STATE);
     if (rom_is_loaded && !state) {
-        flag.set(EMULATOR_STATE, true); // Set the emulator state flag to running
         initialize(); // Initialize the emulator's RAM and registers
-        flag.set(INITIALIZED, true); // Set the initialized flag
-        if (flag.get(HARDWARE_TIMERS)) {
-            ht_start();
-        }
+        begin_running();
         return true; // Successfully started
     } else {
         return false; // Cannot start if ROM isn't loaded or already running
@@ -235,12 +378,39 @@ bool chip8_core::start() {
 }
 
 /**
- * @brief Retrieves the display buffer for rendering.
+ * @brief Retrieves the published frame for rendering.
+ *
+ * The returned buffer only changes in publish_frame(), which never runs while
+ * the renderer owns the frame, so it can be read from another core.
  *
- * @return Pointer to the display buffer.
+ * @return Pointer to the published frame buffer: 256 bytes in 64x32 layout, or 1024 bytes
+ *         in SSD1306 page order if is_hires() (see DISPLAYBUFFER).
  */
 uint8_t* chip8_core::get_display_buffer() {
-    return DISPLAYBUFFER;
+    return FRAMEBUFFER;
+}
+
+/**
+ * @brief Checks if the published frame is a 128x64 SCHIP frame.
+ *
+ * Like get_display_buffer(), this describes the published frame, not the mode the
+ * program is in now, so the renderer can read it while the CPU keeps running.
+ *
+ * @return True if the published frame is 128x64 in SSD1306 page order.
+ */
+bool chip8_core::is_hires() {
+    return frame_hires;
+}
+
+/**
+ * @brief Sets the running flags and starts the hardware timers if they are enabled.
+ */
+void chip8_core::begin_running() {
+    flag.set(EMULATOR_STATE, true); // Set the emulator state flag to running
+    flag.set(INITIALIZED, true); // Set the initialized flag
+    if (flag.get(HARDWARE_TIMERS)) {
+        ht_start();
+    }
 }
 
 /**
@@ -251,9 +421,10 @@ uint8_t* chip8_core::get_display_buffer() {
  *
  * @return True if the emulator was running and has been stopped; otherwise, false.
  */
-bool chip8_core::stop() {
+bool CHIP8_HOT chip8_core::stop() {
     if (flag.get(EMULATOR_STATE)) {
         ht_stop();
+        set_sound(false); // Silence the beeper before the flag is lost
         flag.clear_all(); // Clear all emulator-related flags
         return true; // Successfully stopped
     } else {
@@ -267,56 +438,497 @@ bool chip8_core::stop() {
 /**
  * @brief Executes a CPU cycle, processing instructions based on timing.
  *
- * This function checks if enough time has elapsed since the last CPU cycle
- * and executes an instruction if the CPU timer flag is set or if hardware timers are disabled.
+ * This function checks if enough time has elapsed since the last CPU cycle and executes
+ * one instruction per elapsed CPU_TIMER_INTERVAL slice. With hardware timers, slices missed
+ * while loop() was late are caught up in one batch (at most CPU_MAX_CATCHUP_FRAMES frames).
+ * It is only used in CPU_IPF_LEGACY mode; batched modes are driven from loop() and gpu_cycle().
+ *
+ * @param hardware_timers True if hardware timers drive the cycle, read once per loop() call.
  */
-void chip8_core::cpu_cycle() {
-    unsigned long currentTime = millis(); // Get the current time in milliseconds
-    if ((currentTime - last_CPU_cycle >= CPU_TIMER_INTERVAL && !flag.get(HARDWARE_TIMERS)) ||
-        (flag.get(HARDWARE_TIMERS) && cpu_timer_flag())) {
-        execute();
-        if (!flag.get(HARDWARE_TIMERS)) {
+void CHIP8_HOT chip8_core::cpu_cycle(bool hardware_timers) {
+    if (hardware_timers) {
+        uint32_t slices = take_cpu_ticks();
+        if (slices != 0) {
+            const uint32_t max_slices = CPU_MAX_CATCHUP_FRAMES * GPU_TIMER_INTERVAL_US / (CPU_TIMER_INTERVAL * 1000);
+            run_batch(min(slices, max_slices) * speed_multiplier);
+        }
+    } else {
+        unsigned long currentTime = millis(); // Get the current time in milliseconds
+        if (currentTime - last_CPU_cycle >= CPU_TIMER_INTERVAL) {
+            if (speed_multiplier > 1) {
+                run_batch(speed_multiplier); // Fast-forward: several instructions per slice
+            } else {
+                idle_state.store(IDLE_NONE, std::memory_order_relaxed);
+                CHIP8_PERF_BEGIN(execute);
+                execute();
+                CHIP8_PERF_EXECUTE_END(execute);
+            }
             last_CPU_cycle = currentTime; // Update the last CPU cycle time
-        } else {
-            reset_cpu_timer_flag();
         }
     }
 }
 
+/**
+ * @brief Executes a batch of instructions back to back.
+ *
+ * No timing or flag state is consulted between instructions; if the ROM exits
+ * through 00FD mid-batch, re-executing 00FD is harmless because stop() is idempotent.
+ * With CHIP8_BLOCK_CACHE whole translated blocks run at a time as long as they fit into
+ * the batch; the rest of it is executed instruction by instruction.
+ * Once the program goes idle the rest of the batch would only go round the idle loop,
+ * so it is skipped and PC set to where the loop would have been after the full batch
+ * (see is_idle()); the resulting state is the same as executing every instruction.
+ *
+ * @param count Number of instructions to execute.
+ */
+void CHIP8_HOT chip8_core::run_batch(uint32_t count) {
+    CHIP8_PERF_BEGIN(batch);
+    idle_state.store(IDLE_NONE, std::memory_order_relaxed);
+    uint32_t i = 0;
+    while (i < count) {
+#if CHIP8_BLOCK_CACHE
+        uint32_t executed = run_block(count - i);
+        if (executed == 0) {
+            execute(); // No block fits into the rest of the batch
+            executed = 1;
+        }
+        i += executed;
+#else
+        execute();
+        i++;
+#endif
+        // Instructions that go idle always end a block, so this is checked right after them
+        if (idle_state.load(std::memory_order_relaxed) != IDLE_NONE) {
+            uint32_t remaining = count - i;
+            if (remaining != 0 && idle_loop_length == 3) {
+                reg.V[idle_poll_register] = reg.DELAYTIMER; // Effect of the skipped FX07s
+            }
+            reg.PC += 2 * (remaining % idle_loop_length);
+            break;
+        }
+    }
+    CHIP8_PERF_EXECUTE_END(batch);
+}
+
 /**
  * @brief Executes a GPU cycle, handling timers and drawing operations based on timing.
  *
  * This function checks if enough time has elapsed since the last GPU cycle
  * and performs necessary updates such as drawing the display and handling timers.
+ * With a finite instructions-per-frame setting, the frame's instruction batch runs first.
+ *
+ * Every elapsed 60Hz tick is counted, by the timer interrupt or here from micros()
+ * including the fractional remainder, so the delay and sound timers stay exact even if
+ * loop() was late or the renderer stalled; the CPU catches up at most
+ * CPU_MAX_CATCHUP_FRAMES frames at once.
+ *
+ * @param hardware_timers True if hardware timers drive the cycle, read once per loop() call.
  */
-void chip8_core::gpu_cycle() {
-    unsigned long currentTime = millis(); // Get the current time in milliseconds
-    if ((currentTime - last_GPU_cycle >= GPU_TIMER_INTERVAL && !flag.get(HARDWARE_TIMERS)) ||
-        (flag.get(HARDWARE_TIMERS) && gpu_timer_flag())) {
-        // Check if the CPU has set the draw flag
-        bool cpu_gave_draw_instruction = flag.get(CPU_CYCLE_DRAW_FLAG);
-        if (cpu_gave_draw_instruction) {
-            flag.set(CPU_CYCLE_DRAW_FLAG, false); // Clear the CPU cycle draw flag
-            flag.set(GPU_CYCLE_DRAW_FLAG, true);  // Set the GPU cycle draw flag
+void CHIP8_HOT chip8_core::gpu_cycle(bool hardware_timers) {
+    uint32_t ticks; // Number of 60Hz ticks to process
+    if (hardware_timers) {
+        ticks = take_gpu_ticks();
+        if (ticks == 0) {
+            return;
+        }
+        last_GPU_cycle = micros(); // Tick phase for idle_time_us()
+    } else {
+        unsigned long elapsed = micros() - last_GPU_cycle;
+        if (elapsed < GPU_TIMER_INTERVAL_US) {
+            return;
         }
-        // Decrement the delay timer if it's greater than 0
-        if (reg.DELAYTIMER > 0) {
-            reg.DELAYTIMER--;
+        ticks = elapsed / GPU_TIMER_INTERVAL_US;
+        last_GPU_cycle += ticks * GPU_TIMER_INTERVAL_US; // Keep the remainder for the next tick
+    }
+    if (speed_multiplier > 1) {
+        fast_forward(ticks);
+        return;
+    }
+    // In batched mode the whole frame's worth of instructions runs at the frame boundary
+    uint32_t instructions = 0;
+    if (instructions_per_frame != CPU_IPF_LEGACY && instructions_per_frame != CPU_IPF_UNLIMITED) {
+        instructions = static_cast<uint32_t>(instructions_per_frame) * min(ticks, CPU_MAX_CATCHUP_FRAMES);
+    }
+    frame_tick(ticks, instructions);
+}
+
+/**
+ * @brief Runs the work of one or more elapsed 60Hz frames.
+ *
+ * Executes the frame's instruction batch, then publishes the frame if the CPU drew
+ * and decrements the timers by the number of ticks.
+ *
+ * @param ticks Number of 60Hz ticks that elapsed, at least 1.
+ * @param instructions Number of instructions to execute first (0 outside batched mode).
+ */
+void CHIP8_HOT chip8_core::frame_tick(uint32_t ticks, uint32_t instructions) {
+    if (instructions != 0) {
+        run_batch(instructions);
+        if (!flag.get(EMULATOR_STATE)) {
+            return; // The ROM exited during the batch
         }
-        // Decrement the sound timer if it's greater than 0 and handle sound state
-        if (reg.SOUNDTIMER > 0) {
-            flag.set(SOUND, true); // Set the SOUND flag if sound is active
-            reg.SOUNDTIMER--;
-            if (reg.SOUNDTIMER == 0) {
-                flag.set(SOUND, false); // Clear the SOUND flag when the timer reaches zero
+    }
+    // Publish the frame if the CPU drew and the renderer has released the previous one;
+    // otherwise keep CPU_CYCLE_DRAW_FLAG so the changes are merged into the next frame
+    bool cpu_gave_draw_instruction = flag.get(CPU_CYCLE_DRAW_FLAG);
+    if (cpu_gave_draw_instruction && !flag.get(GPU_CYCLE_DRAW_FLAG)) {
+        publish_frame();
+        flag.set(CPU_CYCLE_DRAW_FLAG, false); // Clear the CPU cycle draw flag
+        flag.set(GPU_CYCLE_DRAW_FLAG, true);  // Hand the frame to the renderer (release)
+    }
+    tick_timers(ticks);
+    CHIP8_PERF_FRAME(ticks);
+}
+
+/**
+ * @brief Emulates speed_multiplier frames for each elapsed 60Hz tick.
+ *
+ * Every frame but the last runs its batch and timer tick without publishing, which
+ * leaves CPU_CYCLE_DRAW_FLAG and the dirty map set, so the frame_tick() of the last
+ * one publishes the final display with all changes merged. As in normal mode, at most
+ * CPU_MAX_CATCHUP_FRAMES ticks' worth of frames get instructions after a stall.
+ *
+ * @param ticks Elapsed real 60Hz ticks.
+ */
+void CHIP8_HOT chip8_core::fast_forward(uint32_t ticks) {
+    const bool batched = instructions_per_frame != CPU_IPF_LEGACY && instructions_per_frame != CPU_IPF_UNLIMITED;
+    const uint32_t frames = ticks * speed_multiplier;
+    const uint32_t batches = batched ? min(ticks, CPU_MAX_CATCHUP_FRAMES) * speed_multiplier : 0;
+    for (uint32_t frame = 1; frame < frames; frame++) {
+        if (frame <= batches) {
+            run_batch(instructions_per_frame);
+            if (!flag.get(EMULATOR_STATE)) {
+                return; // The ROM exited during the batch
             }
         }
-        if (!flag.get(HARDWARE_TIMERS)) {
-            last_GPU_cycle = currentTime; // Update the last GPU cycle time
-        } else {
-            reset_gpu_timer_flag();
+        tick_timers(1);
+        CHIP8_PERF_FRAME(1);
+    }
+    frame_tick(1, frames <= batches ? instructions_per_frame : 0);
+}
+
+/**
+ * @brief Decrements the delay and sound timers by the elapsed ticks, stopping at 0.
+ *
+ * @param ticks Elapsed 60Hz ticks.
+ */
+void CHIP8_HOT chip8_core::tick_timers(uint32_t ticks) {
+    // Decrement the delay timer by the elapsed ticks, stopping at 0
+    if (reg.DELAYTIMER > 0) {
+        reg.DELAYTIMER = (ticks >= reg.DELAYTIMER) ? 0 : reg.DELAYTIMER - ticks;
+    }
+    // Decrement the sound timer by the elapsed ticks and handle sound state
+    if (reg.SOUNDTIMER > 0) {
+        reg.SOUNDTIMER = (ticks >= reg.SOUNDTIMER) ? 0 : reg.SOUNDTIMER - ticks;
+    }
+    set_sound(reg.SOUNDTIMER > 0); // Sound stays on until the timer reaches zero (or a restore cleared it)
+}
+
+/**
+ * @brief Runs exactly one 60Hz frame without consulting the clock.
+ *
+ * Executes 'instructions' instructions, then publishes the frame and decrements the
+ * timers once, just like a frame boundary in loop(). Together with set_random_seed()
+ * and a recorded key sequence fed through set_key_state() this makes a run fully
+ * reproducible, so it can be replayed as fast as the host allows and compared frame
+ * by frame with frame_hash(). Does nothing if the emulator is not running.
+ *
+ * @param instructions Number of instructions to execute in this frame.
+ */
+void chip8_core::step_frame(uint16_t instructions) {
+    if (!flag.get(EMULATOR_STATE)) {
+        return;
+    }
+    frame_tick(1, instructions);
+}
+
+/**
+ * @brief Hashes the emulator state visible to a ROM.
+ *
+ * 64-bit FNV-1a over DISPLAYBUFFER (all 1KB of it in 128x64 mode), V0-VF, I, PC, SP,
+ * the stack and both timers, with 16-bit values hashed low byte first so the result is
+ * the same on every platform.
+ *
+ * @return Hash of the current display buffer and registers.
+ */
+uint64_t chip8_core::frame_hash() {
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](uint8_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    const uint16_t display_bytes = hires ? sizeof(HIRES_DISPLAYBUFFER) : sizeof(DISPLAYBUFFER);
+    for (uint16_t i = 0; i < display_bytes; i++) {
+        add(HIRES_DISPLAYBUFFER[i]);
+    }
+    for (uint8_t i = 0; i < 16; i++) {
+        add(reg.V[i]);
+    }
+    const uint16_t words[2] = {reg.INDEX, reg.PC};
+    for (uint16_t word : words) {
+        add(word & 0xFF);
+        add(word >> 8);
+    }
+    add(reg.SP);
+    for (uint8_t i = 0; i < 16; i++) {
+        add(reg.STACK[i] & 0xFF);
+        add(reg.STACK[i] >> 8);
+    }
+    add(reg.DELAYTIMER);
+    add(reg.SOUNDTIMER);
+    return hash;
+}
+
+/**
+ * @brief Selects the quirk profile, i.e. how the ambiguous instructions behave.
+ *
+ * Switches the dispatch table to the handlers instantiated for the profile, so the
+ * choice costs nothing per instruction. Set it for each ROM, before or after
+ * load_rom(); it is kept until changed. The default is CHIP8_QUIRKS_LEGACY.
+ *
+ * @param profile Quirk profile of the ROM.
+ */
+void chip8_core::set_quirks(chip8_quirk_profile profile) {
+    if (profile >= QUIRK_PROFILES) {
+        profile = CHIP8_QUIRKS_LEGACY;
+    }
+    handlers = HANDLERS[profile];
+    quirks = profile;
+}
+
+/**
+ * @brief Returns the selected quirk profile.
+ *
+ * @return Profile set with set_quirks().
+ */
+chip8_quirk_profile chip8_core::get_quirks() {
+    return quirks;
+}
+
+/**
+ * @brief Computes the checksum stored in a snapshot.
+ *
+ * 32-bit FNV-1a over every byte after the checksum field.
+ *
+ * @param snap Snapshot to check.
+ * @return Checksum of the snapshot's contents.
+ */
+uint32_t chip8_core::snapshot_checksum(const chip8_snapshot& snap) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(&snap.random_state);
+    size_t length = sizeof(chip8_snapshot) - offsetof(chip8_snapshot, random_state);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Saves the complete emulator state.
+ *
+ * Copies the registers, the display buffer, the 4KB memory and the random state into
+ * one self-contained blob. Call it between frames (from the loop callback), not while
+ * loop() runs on another core.
+ *
+ * @param out Snapshot to fill.
+ */
+void chip8_core::snapshot(chip8_snapshot& out) {
+    out.magic = CHIP8_SNAPSHOT_MAGIC;
+    out.version = CHIP8_SNAPSHOT_VERSION;
+    out.size = sizeof(chip8_snapshot);
+    out.random_state = random_state;
+    out.registers = reg;
+    out.hires = hires ? 1 : 0;
+    memset(out.reserved, 0, sizeof(out.reserved));
+    memcpy(out.display, HIRES_DISPLAYBUFFER, sizeof(out.display));
+#if CHIP8_FLASH_ROM
+    for (uint8_t page = 0; page < MEMORY_PAGES; page++) {
+        memcpy(out.ram + page * RAM_PAGE_SIZE, read_pages[page], RAM_PAGE_SIZE);
+    }
+#else
+    memcpy(out.ram, RAM, sizeof(out.ram));
+#endif
+    out.checksum = snapshot_checksum(out);
+}
+
+/**
+ * @brief Resumes from a saved state.
+ *
+ * The snapshot is rejected if its magic, version, size or checksum do not match. A ROM
+ * must have been loaded before, as with start(); with CHIP8_FLASH_ROM it should be the
+ * ROM the snapshot was taken from, so only the pages the game had written need RAM
+ * copies again. The emulator is started if it was not running, without clearing the
+ * restored state, and the whole display is marked dirty for the next frame.
+ *
+ * @param in Snapshot written by snapshot().
+ * @return True if the state was restored; false if the snapshot is invalid, no ROM is
+ *         loaded or (CHIP8_FLASH_ROM) the modified pages do not fit into the RAM pool.
+ */
+bool chip8_core::restore(const chip8_snapshot& in) {
+    if (in.magic != CHIP8_SNAPSHOT_MAGIC || in.version != CHIP8_SNAPSHOT_VERSION ||
+        in.size != sizeof(chip8_snapshot) || in.checksum != snapshot_checksum(in) ||
+        !flag.get(ROM_IS_LOADED)) {
+        return false;
+    }
+
+#if CHIP8_FLASH_ROM
+    // Only pages that differ from what is mapped now need a RAM copy; check they fit first
+    uint8_t pages_needed = ram_pages_used;
+    for (uint8_t page = 0; page < MEMORY_PAGES; page++) {
+        if (write_pages[page] == nullptr &&
+            memcmp(read_pages[page], in.ram + page * RAM_PAGE_SIZE, RAM_PAGE_SIZE) != 0) {
+            pages_needed++;
+        }
+    }
+    if (pages_needed > CHIP8_RAM_PAGES) {
+        return false;
+    }
+    for (uint8_t page = 0; page < MEMORY_PAGES; page++) {
+        const uint8_t* saved = in.ram + page * RAM_PAGE_SIZE;
+        if (memcmp(read_pages[page], saved, RAM_PAGE_SIZE) == 0) {
+            continue;
         }
+        uint8_t* copy = write_pages[page] != nullptr ? write_pages[page] : copy_page(page);
+        memcpy(copy, saved, RAM_PAGE_SIZE);
+    }
+#else
+    memcpy(RAM, in.ram, sizeof(RAM));
+#endif
+    predecode_all();
+
+    reg = in.registers;
+    random_state = in.random_state;
+    hires = in.hires != 0;
+    memcpy(HIRES_DISPLAYBUFFER, in.display, sizeof(HIRES_DISPLAYBUFFER));
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+    idle_state.store(IDLE_NONE, std::memory_order_relaxed);
+    last_CPU_cycle = 0;
+    last_GPU_cycle = micros();
+
+    if (!flag.get(EMULATOR_STATE)) {
+        begin_running();
+    }
+    return true;
+}
+
+/**
+ * @brief Selects the random number source for CXNN.
+ *
+ * A non-zero seed switches CXNN to a xorshift32 generator starting from that seed,
+ * which makes runs reproducible; 0 switches back to the ESP32 hardware RNG. The
+ * generator is not reset by start(), so set the seed before starting a replay.
+ *
+ * @param seed Generator seed, or 0 for the hardware RNG.
+ */
+void chip8_core::set_random_seed(uint32_t seed) {
+    random_state = seed;
+}
+
+/**
+ * @brief Returns the next random byte for CXNN.
+ *
+ * @return The low byte of esp_random(), or of the next xorshift32 value when seeded.
+ */
+uint8_t CHIP8_HOT chip8_core::random_byte() {
+    if (random_state == 0) {
+        return esp_random() & 0xFF;
+    }
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state & 0xFF;
+}
+
+/**
+ * @brief Checks if the program is idle.
+ *
+ * The program is idle while FX0A waits for a key press, or while it spins in a loop
+ * whose outcome cannot change before the next 60Hz tick: a jump to itself, or the
+ * common delay timer poll "FX07; 3XNN/4XNN; 1NNN" jumping back to the FX07. Executing
+ * more instructions until then would only repeat the wait, so batches end early and
+ * play_game() can sleep (see idle_time_us()).
+ *
+ * @return True if the program waits for a key press or the next 60Hz tick.
+ */
+bool chip8_core::is_idle() {
+    return idle_state.load(std::memory_order_relaxed) != IDLE_NONE && flag.get(EMULATOR_STATE);
+}
+
+/**
+ * @brief Returns how long the caller may sleep without delaying the emulation.
+ *
+ * While the program is idle nothing happens before the next 60Hz tick, unless the
+ * program waits in FX0A and a key is pressed, which runs the wake callback.
+ *
+ * @return Microseconds until the next 60Hz tick if idle; otherwise 0.
+ */
+uint32_t chip8_core::idle_time_us() {
+    if (!is_idle()) {
+        return 0;
+    }
+    unsigned long elapsed = micros() - last_GPU_cycle;
+    return elapsed >= GPU_TIMER_INTERVAL_US ? 0 : GPU_TIMER_INTERVAL_US - elapsed;
+}
+
+/**
+ * @brief Sets the function called when a key is pressed while FX0A waits for one.
+ *
+ * The callback runs in the context calling set_key_state() or set_key_mask(), so it
+ * must be safe there; typically it notifies the task sleeping in play_game().
+ *
+ * @param callback Function to call, or nullptr to disable the wake-up.
+ * @param arg Argument passed to the callback.
+ */
+void chip8_core::set_wake_callback(chip8_wake_callback callback, void* arg) {
+    wake_callback = callback;
+    wake_arg = arg;
+}
+
+/**
+ * @brief Runs the wake callback if the program is waiting for a key press.
+ */
+void CHIP8_HOT chip8_core::notify_key_press() {
+    chip8_wake_callback callback = wake_callback;
+    if (callback != nullptr && idle_state.load(std::memory_order_relaxed) == IDLE_KEY) {
+        callback(wake_arg);
+    }
+}
+
+/**
+ * @brief Checks for a delay timer poll at an address that keeps looping until the next tick.
+ *
+ * Matches "FX07; 3XNN" or "FX07; 4XNN" on the same register, where the skip over the
+ * jump back is not taken for the current delay timer value.
+ *
+ * @param address Address of the FX07 instruction.
+ * @return True if the poll cannot end before the delay timer changes.
+ */
+bool CHIP8_HOT chip8_core::is_delay_poll(uint16_t address) {
+    uint16_t load = fetch(address);
+    uint16_t test = fetch(address + 2);
+    if ((load & 0xF0FF) != 0xF007 || (test & 0x0F00) != (load & 0x0F00)) {
+        return false;
     }
+    bool equal = reg.DELAYTIMER == (test & 0x00FF);
+    return ((test & 0xF000) == 0x3000 && !equal) || ((test & 0xF000) == 0x4000 && equal);
+}
+
+/**
+ * @brief Publishes the current display buffer as the next frame for the renderer.
+ *
+ * Copies DISPLAYBUFFER (1KB in 128x64 mode) into FRAMEBUFFER and merges the accumulated dirty cells into
+ * the published frame's map; the renderer clears that map once it has drawn them.
+ * Must only be called while GPU_CYCLE_DRAW_FLAG is clear, i.e. while the renderer
+ * does not own the published frame.
+ */
+void CHIP8_HOT chip8_core::publish_frame() {
+    memcpy(HIRES_FRAMEBUFFER, HIRES_DISPLAYBUFFER, hires ? sizeof(HIRES_FRAMEBUFFER) : sizeof(FRAMEBUFFER));
+    frame_hires = hires;
+    frame_dirty.merge(dirty);
+    dirty.clear();
+    CHIP8_PERF_COUNT(frames_published, 1);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -334,12 +946,26 @@ bool chip8_core::need_to_draw() {
 /**
  * @brief Resets the draw flag after a frame has been drawn.
  *
- * This function clears the GPU cycle draw flag to indicate that drawing is complete.
+ * This function clears the GPU cycle draw flag to indicate that drawing is complete
+ * and hands the published frame back to the core, which may then overwrite it.
  */
 void chip8_core::reset_draw() {
     flag.set(GPU_CYCLE_DRAW_FLAG, false); // Clear the GPU cycle draw flag
 }
 
+/**
+ * @brief Hands the published frame back without drawing it.
+ *
+ * Used by frame pacing to drop a frame: the dirty cells stay in the published map
+ * and the draw request is raised again, so the next frame boundary republishes the
+ * latest display contents with the skipped frame's changes merged in.
+ */
+void chip8_core::skip_frame() {
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);  // Request a fresh publish at the next frame boundary
+    flag.set(GPU_CYCLE_DRAW_FLAG, false); // Release the published frame
+    CHIP8_PERF_COUNT(frames_skipped, 1);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -349,10 +975,18 @@ void chip8_core::reset_draw() {
  * This function should be called repeatedly to process emulator cycles.
  * It ensures that both CPU instructions and GPU updates are handled appropriately.
  */
-void chip8_core::loop() {
+void CHIP8_HOT chip8_core::loop() {
     if (flag.get(INITIALIZED)) {
-        cpu_cycle(); // Perform a CPU cycle to execute instructions
-        gpu_cycle(); // Perform a GPU cycle to handle timers and drawing
+        const bool hardware_timers = flag.get(HARDWARE_TIMERS); // Read once per loop, not per opcode
+        if (instructions_per_frame == CPU_IPF_LEGACY) {
+            cpu_cycle(hardware_timers); // Perform a CPU cycle to execute instructions
+        } else if (instructions_per_frame == CPU_IPF_UNLIMITED) {
+            run_batch(CPU_BATCH_SIZE); // Run as fast as the loop is called
+            if (!flag.get(EMULATOR_STATE)) {
+                return; // The ROM exited during the batch
+            }
+        }
+        gpu_cycle(hardware_timers); // Perform a GPU cycle to handle timers and drawing
     }
 }
 
@@ -368,38 +1002,99 @@ bool chip8_core::sound() {
     return flag.get(SOUND); // Returns true if the SOUND flag is set
 }
 
+/**
+ * @brief Sets the function called when the SOUND flag turns on or off.
+ *
+ * The callback only runs on edges, from gpu_cycle() (or frame_tick()) and stop(), so an
+ * audio backend can set up its output once and just start or stop the tone here instead
+ * of polling sound() every loop.
+ *
+ * @param callback Function to call, or nullptr to disable it.
+ * @param arg Argument passed to the callback.
+ */
+void chip8_core::set_sound_callback(chip8_sound_callback callback, void* arg) {
+    sound_callback = callback;
+    sound_arg = arg;
+}
+
+/**
+ * @brief Updates the SOUND flag and runs the sound callback if it changed.
+ *
+ * @param on True while the sound timer is active.
+ */
+void CHIP8_HOT chip8_core::set_sound(bool on) {
+    if (flag.get(SOUND) == on) {
+        return;
+    }
+    flag.set(SOUND, on);
+    if (sound_callback != nullptr) {
+        sound_callback(sound_arg, on);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
  * @brief Sets the state of a specific key.
  *
+ * Safe to call from another core or an ISR while the emulator runs.
+ *
  * @param key The key index (0x0 to 0xF).
  * @param is_pressed True if the key is pressed; otherwise, false.
  */
 void chip8_core::set_key_state(uint8_t key, bool is_pressed) {
     if (key < 16) { // Ensure the key is within valid range (0x0 to 0xF)
-        key_states[key] = is_pressed ? 1 : 0; // Set state to 1 if pressed, 0 if released
+        uint16_t bit = static_cast<uint16_t>(1 << key);
+        if (is_pressed) {
+            key_mask.fetch_or(bit, std::memory_order_relaxed);
+            notify_key_press();
+        } else {
+            key_mask.fetch_and(static_cast<uint16_t>(~bit), std::memory_order_relaxed);
+        }
     }
 }
 
 /**
- * @brief Checks if a specific key is pressed.
+ * @brief Updates the state of all 16 keys at once.
  *
- * @param key The key index (0x0 to 0xF).
- * @return True if the key is within range and pressed; otherwise, false.
+ * Meant for keypad drivers that scan every key in one go, see gpio_keypad.
+ *
+ * @param mask Pressed keys, bit k set if key k (0x0 to 0xF) is pressed.
  */
-bool chip8_core::is_key_pressed(uint8_t key) {
-    return key < 16 && key_states[key] == 1; // Return true if key is within range and pressed
+void chip8_core::set_key_mask(uint16_t mask) {
+    uint16_t previous = key_mask.exchange(mask, std::memory_order_relaxed);
+    if (mask & ~previous) {
+        notify_key_press();
+    }
 }
 
 /**
- * @brief Checks if the emulator has been initialized and is ready to run.
+ * @brief Retrieves the state of all 16 keys.
  *
- * @return True if the emulator is initialized; otherwise, false.
+ * @return Pressed keys, bit k set if key k is pressed.
  */
-bool chip8_core::is_init_and_ready() {
-    return flag.get(INITIALIZED); // Check if emulator is in initialized state
+uint16_t chip8_core::get_key_mask() {
+    return key_mask.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks if a specific key is pressed.
+ *
+ * @param key The key index (0x0 to 0xF).
+ * @return True if the key is within range and pressed; otherwise, false.
+ */
+bool CHIP8_HOT chip8_core::is_key_pressed(uint8_t key) {
+    return key < 16 && ((key_mask.load(std::memory_order_relaxed) >> key) & 1); // Return true if key is within range and pressed
+}
+
+/**
+ * @brief Checks if the emulator has been initialized and is ready to run.
+ *
+ * @return True if the emulator is initialized; otherwise, false.
+ */
+bool chip8_core::is_init_and_ready() {
+    return flag.get(INITIALIZED); // Check if emulator is in initialized state
 }
 
 /**
@@ -407,307 +1102,960 @@ bool chip8_core::is_init_and_ready() {
  *
  * @return The key value if pressed; otherwise, -1.
  */
-int8_t chip8_core::get_pressed_key() {
-    for (uint8_t key = 0; key < 16; key++) {
-        if (key_states[key] == 1) {
-            return key; // Return the key value if pressed
-        }
-    }
-    return -1; // Return -1 if no key is pressed
+int8_t CHIP8_HOT chip8_core::get_pressed_key() {
+    uint16_t keys = key_mask.load(std::memory_order_relaxed);
+    return keys ? __builtin_ctz(keys) : -1; // Lowest pressed key, or -1 if none is pressed
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Executes the current opcode.
+ * @brief Reads a byte of CHIP-8 memory.
  *
- * This function fetches the opcode from memory, decodes it, and executes the corresponding instruction.
- * It handles all CHIP-8 instruction sets including system, flow control, arithmetic, and graphics operations.
+ * @param address Address to read (wraps at 4KB).
+ * @return The byte at that address.
  */
-void chip8_core::execute() {
-    uint16_t OPCODE = (RAM[reg.PC] << 8) | RAM[reg.PC + 1];
-    switch (OPCODE & 0xF000) {
-        case 0x0000:
-            switch (OPCODE & 0x00FF) {
-                case 0xE0:
-                    // 00E0: Clear the display
-                    memset(DISPLAYBUFFER, 0, sizeof(DISPLAYBUFFER));
-                    memset(dirty_flags, 1, sizeof(dirty_flags));
-                    flag.set(CPU_CYCLE_DRAW_FLAG, true); // Set draw flag
+uint8_t CHIP8_HOT chip8_core::read(uint16_t address) {
+    address &= 0xFFF;
+#if CHIP8_FLASH_ROM
+    return read_pages[address / RAM_PAGE_SIZE][address % RAM_PAGE_SIZE];
+#else
+    return RAM[address];
+#endif
+}
+
+/**
+ * @brief Reads the big-endian opcode stored at the given address.
+ *
+ * @param address Address of the opcode's high byte (wraps at 4KB).
+ * @return The 16-bit opcode.
+ */
+uint16_t CHIP8_HOT chip8_core::fetch(uint16_t address) {
+    return (read(address) << 8) | read(address + 1);
+}
+
+/**
+ * @brief Writes a byte to RAM on behalf of a CHIP-8 instruction.
+ *
+ * All instruction stores go through here so that a cached decode of the affected
+ * instruction is invalidated and self-modifying ROMs keep working.
+ *
+ * @param address Target address (wraps at 4KB).
+ * @param value Byte to store.
+ */
+void CHIP8_HOT chip8_core::store(uint16_t address, uint8_t value) {
+    address &= 0xFFF;
+#if CHIP8_FLASH_ROM
+    uint8_t* page = write_pages[address / RAM_PAGE_SIZE];
+    if (page == nullptr && (page = copy_page(address / RAM_PAGE_SIZE)) == nullptr) {
+        stop(); // Out of RAM pages; CHIP8_RAM_PAGES is too small for this ROM
+        return;
+    }
+    page[address % RAM_PAGE_SIZE] = value;
+#else
+    RAM[address] = value;
+#endif
+#if CHIP8_PREDECODE_CACHE
+    if (address >= 0x200) {
+        decode_cache[(address - 0x200) >> 1].handler = OP_UNDECODED;
+    }
+#endif
+#if CHIP8_BLOCK_CACHE
+    if (address >= 0x200) {
+        uint16_t slot = (address - 0x200) >> 1;
+        if (block_coverage[slot >> 5] & (1UL << (slot & 31))) {
+            flush_blocks(); // Self-modifying code; FX55/FX33 end their block, so none is running
+            CHIP8_PERF_COUNT(block_flushes, 1);
+        }
+    }
+#endif
+}
+
+#if CHIP8_FLASH_ROM
+/**
+ * @brief Gives a memory page its own RAM copy so it can be written.
+ *
+ * Copies the page's current contents (flash ROM or zeros) into the next free page of
+ * the pool and maps the page to it for reads and writes.
+ *
+ * @param page Page number (address / RAM_PAGE_SIZE).
+ * @return The page's RAM copy, or nullptr if all CHIP8_RAM_PAGES pages are in use.
+ */
+uint8_t* chip8_core::copy_page(uint8_t page) {
+    if (ram_pages_used >= CHIP8_RAM_PAGES) {
+        return nullptr;
+    }
+    uint8_t* copy = RAM[ram_pages_used++];
+    memcpy(copy, read_pages[page], RAM_PAGE_SIZE);
+    read_pages[page] = copy;
+    write_pages[page] = copy;
+    return copy;
+}
+#endif
+
+/**
+ * @brief Decodes the whole program area (0x200-0xFFF) into the predecode cache.
+ *
+ * Called after a ROM has been loaded; does nothing if the cache is compiled out.
+ */
+void chip8_core::predecode_all() {
+#if CHIP8_PREDECODE_CACHE
+    for (uint16_t slot = 0; slot < DECODE_CACHE_SLOTS; slot++) {
+        decode_cache[slot] = decode(fetch(0x200 + (slot << 1)));
+    }
+#endif
+#if CHIP8_BLOCK_CACHE
+    flush_blocks();
+#endif
+}
+
+#if CHIP8_BLOCK_CACHE
+/**
+ * @brief Runs the translated basic block starting at PC.
+ *
+ * Dispatches the block's instructions back to back without looking up PC in between,
+ * and executes the fused pairs inline. The block is only run if all of it fits into
+ * 'max_instructions', so a batch never executes more instructions than asked for.
+ *
+ * @param max_instructions Instructions left in the batch.
+ * @return Instructions executed, 0 if PC is outside the program area or the block does
+ *         not fit.
+ */
+uint32_t CHIP8_HOT chip8_core::run_block(uint32_t max_instructions) {
+    if (static_cast<uint16_t>(reg.PC - 0x200) > 0xDFE) {
+        return 0;
+    }
+    const code_block& block = find_block(reg.PC);
+    const uint8_t length = block.length; // A store at the end of the block may flush it
+    if (length > max_instructions) {
+        return 0;
+    }
+    const decoded_op* ops = block.ops;
+    uint32_t executed = 0;
+    for (uint8_t k = 0; k < length; k++) {
+        const decoded_op& op = ops[k];
+        switch (op.handler) {
+            case OP_FUSED_LD_ADD:
+                CHIP8_PERF_OPCODE(0x6);
+                CHIP8_PERF_OPCODE(0x7);
+                reg.V[op.x] = op.arg;
+                reg.V[ops[k + 1].x] += ops[k + 1].arg;
+                reg.PC += 4;
+                executed += 2;
+                k++;
+                break;
+            case OP_FUSED_SE_JP:
+            case OP_FUSED_SNE_JP:
+                // Last pair of the block: the jump runs only if the compare does not skip it
+                CHIP8_PERF_OPCODE(op.handler == OP_FUSED_SE_JP ? 0x3 : 0x4);
+                executed++;
+                if ((reg.V[op.x] == op.arg) == (op.handler == OP_FUSED_SE_JP)) {
+                    reg.PC += 4;
+                } else {
                     reg.PC += 2;
-                    break;
-                case 0xEE:
-                    // 00EE: Return from subroutine
-                    reg.PC = reg.STACK[--reg.SP];
-                    break;
-                case 0xFD:
-                    // 00FD: Exit CHIP-8/SCHIP interpreter
-                    stop(); // Custom function to halt the emulator
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case 0x1000:
-            // 1NNN: Jump to address NNN
-            reg.PC = OPCODE & 0x0FFF;
-            break;
-        case 0x2000:
-            // 2NNN: Call subroutine at NNN
-            if (reg.SP < 16) {
-                reg.STACK[reg.SP++] = reg.PC + 2; // Push the current PC onto the stack
-                reg.PC = OPCODE & 0x0FFF;         // Jump to the address specified by the opcode
-            } else {
-                reg.PC += 2; // If stack is full, increment PC to skip this instruction
-            }
-            break;
-        case 0x3000:
-            // 3XNN: Skip next instruction if Vx equals NN
-            if (reg.V[(OPCODE & 0x0F00) >> 8] == (OPCODE & 0x00FF)) {
-                reg.PC += 4; // Skip next instruction
-            } else {
-                reg.PC += 2;
+                    CHIP8_PERF_OPCODE(0x1);
+                    op_jp(ops[k + 1]);
+                    executed++;
+                }
+                k++;
+                break;
+            default:
+                CHIP8_PERF_OPCODE(OP_CLASS[op.handler]);
+                (this->*handlers[op.handler])(op);
+                executed++;
+                break;
+        }
+    }
+    return executed;
+}
+
+/**
+ * @brief Looks up the translated block starting at pc, translating it on a miss.
+ *
+ * The cache is set-associative: pc selects a set of CHIP8_BLOCK_CACHE_WAYS blocks, and
+ * a miss replaces the least recently used block of the set. Bit 0 of pc takes part in
+ * the set index because some ROMs run entirely from odd addresses. Ages are compared as
+ * block_clock - last_used, so the LRU order survives block_clock wrapping around after
+ * 2^32 lookups (a few hours of play).
+ *
+ * @param pc Address in the program area (0x200-0xFFE).
+ * @return The block starting at pc.
+ */
+CHIP8_HOT chip8_core::code_block& chip8_core::find_block(uint16_t pc) {
+    code_block* set = &blocks[(((pc >> 1) ^ pc) % CHIP8_BLOCK_CACHE_SETS) * CHIP8_BLOCK_CACHE_WAYS];
+    code_block* victim = set;
+    block_clock++;
+    for (uint8_t way = 0; way < CHIP8_BLOCK_CACHE_WAYS; way++) {
+        if (set[way].pc == pc) {
+            set[way].last_used = block_clock;
+            return set[way];
+        }
+        if (block_clock - set[way].last_used > block_clock - victim->last_used) {
+            victim = &set[way];
+        }
+    }
+    translate(*victim, pc);
+    victim->last_used = block_clock;
+    return *victim;
+}
+
+/**
+ * @brief Translates the basic block starting at pc.
+ *
+ * Collects decoded instructions up to and including the first one that ends a block
+ * (see ends_block()), at most CHIP8_BLOCK_MAX_OPS. A 3XNN/4XNN directly followed by
+ * 1NNN becomes a conditional branch, and 6XNN followed by 7YMM one fused load-add.
+ * Every covered 2-byte slot (two for an instruction at an odd address) is marked so that
+ * a store into it flushes the cache.
+ *
+ * @param block Block to overwrite.
+ * @param pc Start address in the program area (0x200-0xFFE).
+ */
+void CHIP8_HOT chip8_core::translate(code_block& block, uint16_t pc) {
+    CHIP8_PERF_COUNT(blocks_translated, 1);
+    block.pc = pc;
+    uint8_t length = 0;
+    for (uint16_t address = pc; address <= 0xFFE && length < CHIP8_BLOCK_MAX_OPS; address += 2) {
+        decoded_op op = decode(fetch(address));
+        block.ops[length++] = op;
+        cover_block_slots(address);
+        if (!ends_block(op.handler)) {
+            continue;
+        }
+        // A skip over a jump is a conditional branch; fuse it if the jump fits
+        bool is_skip_nn = op.handler == OP_SE_NN || op.handler == OP_SNE_NN;
+        if (is_skip_nn && address + 2 <= 0xFFE && length < CHIP8_BLOCK_MAX_OPS) {
+            decoded_op next = decode(fetch(address + 2));
+            if (next.handler == OP_JP) {
+                block.ops[length - 1].handler = op.handler == OP_SE_NN ? OP_FUSED_SE_JP : OP_FUSED_SNE_JP;
+                block.ops[length++] = next;
+                cover_block_slots(address + 2);
             }
-            break;
-        case 0x4000:
-            // 4XNN: Skip next instruction if Vx does not equal NN
-            if (reg.V[(OPCODE & 0x0F00) >> 8] != (OPCODE & 0x00FF)) {
-                reg.PC += 4; // Skip next instruction
-            } else {
-                reg.PC += 2;
+        }
+        break;
+    }
+    block.length = length;
+
+    // Fuse load-immediate + add-immediate pairs
+    for (uint8_t k = 0; k + 1 < length; k++) {
+        if (block.ops[k].handler == OP_LD_NN && block.ops[k + 1].handler == OP_ADD_NN) {
+            block.ops[k].handler = OP_FUSED_LD_ADD;
+            k++;
+        }
+    }
+}
+
+/**
+ * @brief Marks the coverage slots of the instruction at address as translated.
+ *
+ * @param address Address of the instruction (0x200-0xFFE).
+ */
+void CHIP8_HOT chip8_core::cover_block_slots(uint16_t address) {
+    uint16_t first = (address - 0x200) >> 1;
+    uint16_t last = (address + 1 - 0x200) >> 1;
+    block_coverage[first >> 5] |= 1UL << (first & 31);
+    block_coverage[last >> 5] |= 1UL << (last & 31);
+}
+
+/**
+ * @brief Drops all translated blocks.
+ *
+ * Called when a ROM is loaded or restored and when a store hits translated code.
+ * Coverage bits of blocks replaced since the last flush are only cleared here, which
+ * at worst causes an unnecessary flush.
+ */
+void CHIP8_HOT chip8_core::flush_blocks() {
+    for (code_block& block : blocks) {
+        block.pc = BLOCK_EMPTY;
+        block.last_used = 0;
+    }
+    block_clock = 0;
+    memset(block_coverage, 0, sizeof(block_coverage));
+}
+
+/**
+ * @brief Checks if an instruction ends a basic block.
+ *
+ * Branches, skips, calls and returns change PC; 00FD, 0NNN and FX0A may stop or wait;
+ * FX55 and FX33 store into memory and may overwrite translated code.
+ *
+ * @param handler op_index of the instruction.
+ * @return True if the block ends with this instruction.
+ */
+bool CHIP8_HOT chip8_core::ends_block(uint8_t handler) {
+    switch (handler) {
+        case OP_SYS: case OP_RET: case OP_EXIT: case OP_JP: case OP_CALL:
+        case OP_SE_NN: case OP_SNE_NN: case OP_SE_XY: case OP_SNE_XY: case OP_JP_V0:
+        case OP_SKP: case OP_SKNP: case OP_LD_KEY: case OP_BCD: case OP_STORE:
+            return true;
+        default:
+            return false;
+    }
+}
+#endif
+
+/**
+ * @brief Translates an opcode into a handler index and pre-extracted operands.
+ *
+ * This is the only place where opcodes are pattern-matched; the handlers below
+ * implement the behavior of each instruction.
+ *
+ * @param opcode The 16-bit CHIP-8 opcode.
+ * @return The decoded instruction.
+ */
+chip8_core::decoded_op CHIP8_HOT chip8_core::decode(uint16_t opcode) {
+    const uint8_t x = (opcode & 0x0F00) >> 8;
+    const uint8_t y = (opcode & 0x00F0) >> 4;
+    const uint16_t nn = opcode & 0x00FF;
+    const uint16_t nnn = opcode & 0x0FFF;
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            switch (nn) {
+                case 0xE0: return {OP_CLS, 0, 0};
+                case 0xEE: return {OP_RET, 0, 0};
+                case 0xFB: return {OP_SCR, 0, 0};
+                case 0xFC: return {OP_SCL, 0, 0};
+                case 0xFD: return {OP_EXIT, 0, 0};
+                case 0xFE: return {OP_LOW, 0, 0};
+                case 0xFF: return {OP_HIGH, 0, 0};
+                default:
+                    if ((nn & 0xF0) == 0xC0) {
+                        return {OP_SCD, 0, static_cast<uint16_t>(nn & 0x0F)};
+                    }
+                    return {OP_SYS, 0, nnn};
             }
-            break;
-        case 0x5000:
-            // 5XY0: Skip next instruction if Vx equals Vy
-            if (reg.V[(OPCODE & 0x0F00) >> 8] == reg.V[(OPCODE & 0x00F0) >> 4]) {
-                reg.PC += 4;
-            } else {
-                reg.PC += 2;
+        case 0x1000: return {OP_JP, 0, nnn};
+        case 0x2000: return {OP_CALL, 0, nnn};
+        case 0x3000: return {OP_SE_NN, x, nn};
+        case 0x4000: return {OP_SNE_NN, x, nn};
+        case 0x5000: return {OP_SE_XY, x, y};
+        case 0x6000: return {OP_LD_NN, x, nn};
+        case 0x7000: return {OP_ADD_NN, x, nn};
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0: return {OP_LD_XY, x, y};
+                case 0x1: return {OP_OR, x, y};
+                case 0x2: return {OP_AND, x, y};
+                case 0x3: return {OP_XOR, x, y};
+                case 0x4: return {OP_ADD_XY, x, y};
+                case 0x5: return {OP_SUB, x, y};
+                case 0x6: return {OP_SHR, x, y};
+                case 0x7: return {OP_SUBN, x, y};
+                case 0xE: return {OP_SHL, x, y};
+                default:  return {OP_NOP, 0, 0};
             }
-            break;
-        case 0x6000:
-            // 6XNN: Set Vx = NN
-            reg.V[(OPCODE & 0x0F00) >> 8] = (OPCODE & 0x00FF);
-            reg.PC += 2;
-            break;
-        case 0x7000:
-            // 7XNN: Set Vx = Vx + NN
-            reg.V[(OPCODE & 0x0F00) >> 8] += (OPCODE & 0x00FF);
-            reg.PC += 2;
-            break;
-        case 0x8000: {
-            // 8XYN: Various arithmetic and logical operations
-            uint8_t X = (OPCODE & 0x0F00) >> 8;
-            uint8_t Y = (OPCODE & 0x00F0) >> 4;
-            switch (OPCODE & 0x000F) {
-                case 0x0:
-                    // 8XY0: Set Vx = Vy
-                    reg.V[X] = reg.V[Y];
-                    reg.PC += 2;
-                    break;
-                case 0x1:
-                    // 8XY1: Set Vx = Vx OR Vy
-                    reg.V[X] |= reg.V[Y];
-                    reg.PC += 2;
-                    break;
-                case 0x2:
-                    // 8XY2: Set Vx = Vx AND Vy
-                    reg.V[X] &= reg.V[Y];
-                    reg.PC += 2;
-                    break;
-                case 0x3:
-                    // 8XY3: Set Vx = Vx XOR Vy
-                    reg.V[X] ^= reg.V[Y];
-                    reg.PC += 2;
-                    break;
-                case 0x4: {
-                    // 8XY4: Set Vx = Vx + Vy, set VF = carry
-                    uint16_t sum = reg.V[X] + reg.V[Y];
-                    reg.V[0xF] = (sum > 0xFF) ? 1 : 0;
-                    reg.V[X] = sum & 0xFF;
-                    reg.PC += 2;
-                } break;
-                case 0x5:
-                    // 8XY5: Set Vx = Vx - Vy, set VF = NOT borrow
-                    reg.V[0xF] = (reg.V[X] > reg.V[Y]) ? 1 : 0;
-                    reg.V[X] -= reg.V[Y];
-                    reg.PC += 2;
-                    break;
-                case 0x6:
-                    // 8XY6: Set Vx = Vx SHR 1, set VF = least significant bit before shift
-                    reg.V[0xF] = (reg.V[X] & 0x1);
-                    reg.V[X] >>= 1;
-                    reg.PC += 2;
-                    break;
-                case 0x7:
-                    // 8XY7: Set Vx = Vy - Vx, set VF = NOT borrow
-                    reg.V[0xF] = (reg.V[Y] > reg.V[X]) ? 1 : 0;
-                    reg.V[X] = reg.V[Y] - reg.V[X];
-                    reg.PC += 2;
-                    break;
-                case 0xE:
-                    // 8XYE: Set Vx = Vx SHL 1, set VF = most significant bit before shift
-                    reg.V[0xF] = (reg.V[X] & 0x80) ? 1 : 0;
-                    reg.V[X] <<= 1;
-                    reg.PC += 2;
-                    break;
-                default:
-                    reg.PC += 2;
-                    break;
+        case 0x9000: return {OP_SNE_XY, x, y};
+        case 0xA000: return {OP_LD_I, 0, nnn};
+        case 0xB000: return {OP_JP_V0, 0, nnn};
+        case 0xC000: return {OP_RND, x, nn};
+        case 0xD000: return {OP_DRW, x, static_cast<uint16_t>(opcode & 0x00FF)};
+        case 0xE000:
+            switch (nn) {
+                case 0x9E: return {OP_SKP, x, 0};
+                case 0xA1: return {OP_SKNP, x, 0};
+                default:   return {OP_NOP, 0, 0};
             }
-        } break;
-        case 0x9000:
-            // 9XY0: Skip next instruction if Vx != Vy
-            if (reg.V[(OPCODE & 0x0F00) >> 8] != reg.V[(OPCODE & 0x00F0) >> 4]) {
-                reg.PC += 4;
-            } else {
-                reg.PC += 2;
+        case 0xF000:
+            switch (nn) {
+                case 0x07: return {OP_LD_X_DT, x, 0};
+                case 0x0A: return {OP_LD_KEY, x, 0};
+                case 0x15: return {OP_LD_DT_X, x, 0};
+                case 0x18: return {OP_LD_ST_X, x, 0};
+                case 0x1E: return {OP_ADD_I, x, 0};
+                case 0x29: return {OP_FONT, x, 0};
+                case 0x30: return {OP_BIG_FONT, x, 0};
+                case 0x33: return {OP_BCD, x, 0};
+                case 0x55: return {OP_STORE, x, 0};
+                case 0x65: return {OP_LOAD, x, 0};
+                default:   return {OP_NOP, 0, 0};
             }
-            break;
-        case 0xA000:
-            // ANNN: Set I = NNN
-            reg.INDEX = (OPCODE & 0x0FFF);
-            reg.PC += 2;
-            break;
-        case 0xB000:
-            // BNNN: Jump to address NNN + V0
-            reg.PC = ((OPCODE & 0x0FFF) + reg.V[0]);
-            break;
-        case 0xC000:
-            // CXNN: Set Vx = random byte AND NN
-            reg.V[(OPCODE & 0x0F00) >> 8] = ((esp_random() & 0xFF) & (OPCODE & 0x00FF));
-            reg.PC += 2;
-            break;
-        case 0xD000: {
-            // DXYN: Draw a sprite at coordinate (Vx, Vy) with width 8 pixels and height N pixels
-            uint8_t X = reg.V[(OPCODE >> 8) & 0x0F];
-            uint8_t Y = reg.V[(OPCODE >> 4) & 0x0F];
-            uint8_t height = OPCODE & 0x000F;
-            reg.V[0xF] = 0;
-
-            for (uint8_t yline = 0; yline < height; yline++) {
-                uint8_t pixel = RAM[reg.INDEX + yline];
-                uint8_t y_coord = (Y + yline) & 31;
-
-                for (uint8_t xline = 0; xline < 8; xline++) {
-                    if (pixel & (0x80 >> xline)) {
-                        uint8_t x_coord = (X + xline) & 63;
-                        uint16_t bit_index = x_coord + y_coord * 64;
-                        uint8_t& byte = DISPLAYBUFFER[bit_index >> 3];
-                        uint8_t bit = 7 - (bit_index & 0x07);
-
-                        if (byte & (1 << bit)) reg.V[0xF] = 1;
-                        byte ^= (1 << bit);  // Toggle pixel
-
-                        // Mark the corresponding byte in dirty_flags as dirty
-                        dirty_flags[y_coord][x_coord / 8] = 1;
-                    }
+        default:
+            return {OP_NOP, 0, 0};
+    }
+}
+
+/**
+ * @brief Handler dispatch table of each quirk profile, indexed by chip8_quirk_profile and op_index.
+ */
+#define CHIP8_HANDLER_TABLE(profile) { \
+    &chip8_core::op_undecoded, \
+    &chip8_core::op_nop, \
+    &chip8_core::op_sys, \
+    &chip8_core::op_cls, \
+    &chip8_core::op_ret, \
+    &chip8_core::op_exit, \
+    &chip8_core::op_scd, \
+    &chip8_core::op_scr, \
+    &chip8_core::op_scl, \
+    &chip8_core::op_low, \
+    &chip8_core::op_high, \
+    &chip8_core::op_jp, \
+    &chip8_core::op_call, \
+    &chip8_core::op_se_nn, \
+    &chip8_core::op_sne_nn, \
+    &chip8_core::op_se_xy, \
+    &chip8_core::op_ld_nn, \
+    &chip8_core::op_add_nn, \
+    &chip8_core::op_ld_xy, \
+    &chip8_core::op_or_##profile, \
+    &chip8_core::op_and_##profile, \
+    &chip8_core::op_xor_##profile, \
+    &chip8_core::op_add_xy, \
+    &chip8_core::op_sub, \
+    &chip8_core::op_shr_##profile, \
+    &chip8_core::op_subn, \
+    &chip8_core::op_shl_##profile, \
+    &chip8_core::op_sne_xy, \
+    &chip8_core::op_ld_i, \
+    &chip8_core::op_jp_v0_##profile, \
+    &chip8_core::op_rnd, \
+    &chip8_core::op_drw, \
+    &chip8_core::op_skp, \
+    &chip8_core::op_sknp, \
+    &chip8_core::op_ld_x_dt, \
+    &chip8_core::op_ld_key, \
+    &chip8_core::op_ld_dt_x, \
+    &chip8_core::op_ld_st_x, \
+    &chip8_core::op_add_i, \
+    &chip8_core::op_font, \
+    &chip8_core::op_big_font, \
+    &chip8_core::op_bcd, \
+    &chip8_core::op_store_##profile, \
+    &chip8_core::op_load_##profile, \
+}
+CHIP8_HOT_DATA const chip8_core::op_handler chip8_core::HANDLERS[QUIRK_PROFILES][OP_COUNT] = {
+    CHIP8_HANDLER_TABLE(legacy),  // CHIP8_QUIRKS_LEGACY
+    CHIP8_HANDLER_TABLE(cosmac),  // CHIP8_QUIRKS_COSMAC
+    CHIP8_HANDLER_TABLE(schip),   // CHIP8_QUIRKS_SCHIP
+    CHIP8_HANDLER_TABLE(xochip),  // CHIP8_QUIRKS_XOCHIP
+};
+#undef CHIP8_HANDLER_TABLE
+
+#if CHIP8_PERF
+/**
+ * @brief Opcode class reported for each handler, indexed by op_index.
+ */
+CHIP8_HOT_DATA const uint8_t chip8_core::OP_CLASS[OP_COUNT] = {
+    16,                                     // OP_UNDECODED (counted as a predecode miss)
+    0, 0, 0, 0, 0,                          // OP_NOP, OP_SYS, OP_CLS, OP_RET, OP_EXIT
+    0, 0, 0, 0, 0,                          // OP_SCD, OP_SCR, OP_SCL, OP_LOW, OP_HIGH
+    0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7,      // OP_JP to OP_ADD_NN
+    0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8,  // OP_LD_XY to OP_SHL
+    0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xE,      // OP_SNE_XY to OP_SKNP
+    0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF,  // OP_LD_X_DT to OP_LOAD
+};
+#endif
+
+/**
+ * @brief Executes the current opcode.
+ *
+ * With the predecode cache, instructions at even addresses in the program area are
+ * dispatched straight from their cached decode; a slot invalidated by a store decodes
+ * itself again through op_undecoded(). Anything else is fetched and decoded on the fly.
+ */
+void CHIP8_HOT chip8_core::execute() {
+#if CHIP8_PREDECODE_CACHE
+    const uint16_t offset = reg.PC - 0x200;
+    if (offset < 0xE00 && !(offset & 1)) {
+        const decoded_op& op = decode_cache[offset >> 1];
+        CHIP8_PERF_OPCODE(OP_CLASS[op.handler]);
+        (this->*handlers[op.handler])(op);
+        return;
+    }
+#endif
+    const decoded_op op = decode(fetch(reg.PC));
+    CHIP8_PERF_OPCODE(OP_CLASS[op.handler]);
+    (this->*handlers[op.handler])(op);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Decodes the instruction at PC into its cache slot, then executes it
+void CHIP8_HOT chip8_core::op_undecoded(const decoded_op&) {
+#if CHIP8_PREDECODE_CACHE
+    decoded_op& slot = decode_cache[(reg.PC - 0x200) >> 1];
+    slot = decode(fetch(reg.PC));
+    CHIP8_PERF_OPCODE(OP_CLASS[slot.handler]);
+    (this->*handlers[slot.handler])(slot);
+#endif
+}
+
+/// Unknown instruction: skip it
+void CHIP8_HOT chip8_core::op_nop(const decoded_op&) {
+    reg.PC += 2;
+}
+
+/// 0NNN: Call machine code routine (unsupported, PC is left unchanged)
+void CHIP8_HOT chip8_core::op_sys(const decoded_op&) {
+}
+
+/// 00E0: Clear the display
+void CHIP8_HOT chip8_core::op_cls(const decoded_op&) {
+    memset(HIRES_DISPLAYBUFFER, 0, hires ? sizeof(HIRES_DISPLAYBUFFER) : sizeof(DISPLAYBUFFER));
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true); // Set draw flag
+    reg.PC += 2;
+}
+
+/// 00EE: Return from subroutine
+void CHIP8_HOT chip8_core::op_ret(const decoded_op&) {
+    reg.PC = reg.STACK[--reg.SP];
+}
+
+/// 00FD: Exit CHIP-8/SCHIP interpreter
+void CHIP8_HOT chip8_core::op_exit(const decoded_op&) {
+    stop(); // Custom function to halt the emulator
+}
+
+/// 00CN: Scroll the display down by N pixels (SCHIP; 64x32 pixels in 64x32 mode)
+void CHIP8_HOT chip8_core::op_scd(const decoded_op& op) {
+    const uint8_t n = op.arg;
+    if (hires) {
+        // Whole pages move with one memmove, the remaining bits shift down through each column
+        const uint8_t pages = n >> 3;
+        const uint8_t bits = n & 7;
+        memmove(HIRES_DISPLAYBUFFER + pages * 128, HIRES_DISPLAYBUFFER, (8 - pages) * 128);
+        memset(HIRES_DISPLAYBUFFER, 0, pages * 128);
+        if (bits != 0) {
+            for (uint8_t page = 7; page > pages; page--) {
+                uint8_t* column = &HIRES_DISPLAYBUFFER[page * 128];
+                const uint8_t* above = column - 128;  // Same columns of the page above
+                for (uint8_t x = 0; x < 128; x++) {
+                    column[x] = (column[x] << bits) | (above[x] >> (8 - bits));
                 }
             }
+            uint8_t* column = &HIRES_DISPLAYBUFFER[pages * 128];
+            for (uint8_t x = 0; x < 128; x++) {
+                column[x] <<= bits;
+            }
+        }
+    } else {
+        memmove(DISPLAYBUFFER + n * 8, DISPLAYBUFFER, sizeof(DISPLAYBUFFER) - n * 8);
+        memset(DISPLAYBUFFER, 0, n * 8);
+    }
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+    reg.PC += 2;
+}
 
-            reg.PC += 2;
-            flag.set(CPU_CYCLE_DRAW_FLAG, true);
-        } break;
-        case 0xE000: {
-            // EX9E and EXA1: Key operations
-            uint8_t X = (OPCODE & 0x0F00) >> 8;
-            uint8_t key = reg.V[X];
-            switch (OPCODE & 0x00FF) {
-                case 0x9E:
-                    // EX9E: Skip next instruction if key with the value of Vx is pressed
-                    if (is_key_pressed(key)) {
-                        reg.PC += 4;
-                    } else {
-                        reg.PC += 2;
-                    }
-                    break;
-                case 0xA1:
-                    // EXA1: Skip next instruction if key with the value of Vx is not pressed
-                    if (!is_key_pressed(key)) {
-                        reg.PC += 4;
-                    } else {
-                        reg.PC += 2;
-                    }
-                    break;
-                default:
-                    reg.PC += 2;
-                    break;
+/// 00FB: Scroll the display right by 4 pixels (SCHIP)
+void CHIP8_HOT chip8_core::op_scr(const decoded_op&) {
+    if (hires) {
+        for (uint8_t page = 0; page < 8; page++) {
+            uint8_t* column = &HIRES_DISPLAYBUFFER[page * 128];
+            memmove(column + 4, column, 128 - 4);
+            memset(column, 0, 4);
+        }
+    } else {
+        for (uint8_t y = 0; y < 32; y++) {
+            uint8_t* row = &DISPLAYBUFFER[y * 8];
+            for (uint8_t col = 7; col > 0; col--) {
+                row[col] = (row[col] >> 4) | (row[col - 1] << 4);
             }
-        } break;
-        case 0xF000: {
-            // FXNN: Various operations related to timers, memory, and input
-            uint8_t X = (OPCODE & 0x0F00) >> 8;
-            switch (OPCODE & 0x00FF) {
-                case 0x07:
-                    // FX07: Set Vx = delay timer value
-                    reg.V[X] = reg.DELAYTIMER;
-                    reg.PC += 2;
-                    break;
-                case 0x15:
-                    // FX15: Set delay timer = Vx
-                    reg.DELAYTIMER = reg.V[X];
-                    reg.PC += 2;
-                    break;
-                case 0x18:
-                    // FX18: Set sound timer = Vx
-                    reg.SOUNDTIMER = reg.V[X];
-                    reg.PC += 2;
-                    break;
-                case 0x0A: {
-                    // FX0A: Wait for a key press, then store the value of the key in Vx
-                    int8_t pressed_key = get_pressed_key();
-                    if (pressed_key != -1) {
-                        reg.V[X] = pressed_key;
-                        reg.PC += 2;
-                    }
-                    // If no key is pressed, do not increment PC to wait for key press
-                } break;
-                case 0x1E:
-                    // FX1E: Set I = I + Vx, set VF = carry
-                    reg.INDEX += reg.V[X];
-                    reg.V[0xF] = (reg.INDEX > 0xFFF) ? 1 : 0;
-                    reg.INDEX &= 0xFFF;
-                    reg.PC += 2;
-                    break;
-                case 0x29:
-                    // FX29: Set I = location of sprite for digit Vx
-                    reg.INDEX = 0x50 + (reg.V[X] * 5);
-                    reg.PC += 2;
-                    break;
-                case 0x30:
-                    // FX30: Set I = location of 10-byte font sprite for digit Vx (SCHIP)
-                    reg.INDEX = 0xA0 + (reg.V[X] * 10);
-                    reg.PC += 2;
-                    break;
-                case 0x33:
-                    // FX33: Store BCD representation of Vx in memory locations I, I+1, and I+2
-                    RAM[reg.INDEX] = reg.V[X] / 100;
-                    RAM[reg.INDEX + 1] = (reg.V[X] / 10) % 10;
-                    RAM[reg.INDEX + 2] = reg.V[X] % 10;
-                    reg.PC += 2;
-                    break;
-                case 0x55:
-                    // FX55: Store registers V0 through Vx in memory starting at location I
-                    for (uint8_t reg1 = 0; reg1 <= X; ++reg1) {
-                        RAM[reg.INDEX + reg1] = reg.V[reg1];
-                    }
-                    reg.PC += 2;
-                    break;
-                case 0x65:
-                    // FX65: Read registers V0 through Vx from memory starting at location I
-                    for (uint8_t reg1 = 0; reg1 <= X; ++reg1) {
-                        reg.V[reg1] = RAM[reg.INDEX + reg1];
-                    }
-                    reg.PC += 2;
-                    break;
-                default:
-                    reg.PC += 2;
-                    break;
+            row[0] >>= 4;
+        }
+    }
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+    reg.PC += 2;
+}
+
+/// 00FC: Scroll the display left by 4 pixels (SCHIP)
+void CHIP8_HOT chip8_core::op_scl(const decoded_op&) {
+    if (hires) {
+        for (uint8_t page = 0; page < 8; page++) {
+            uint8_t* column = &HIRES_DISPLAYBUFFER[page * 128];
+            memmove(column, column + 4, 128 - 4);
+            memset(column + 128 - 4, 0, 4);
+        }
+    } else {
+        for (uint8_t y = 0; y < 32; y++) {
+            uint8_t* row = &DISPLAYBUFFER[y * 8];
+            for (uint8_t col = 0; col < 7; col++) {
+                row[col] = (row[col] << 4) | (row[col + 1] >> 4);
             }
-        } break;
-        default:
-            reg.PC += 2;
-            break;
+            row[7] <<= 4;
+        }
+    }
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+    reg.PC += 2;
+}
+
+/// 00FE: Switch to 64x32 mode (SCHIP)
+void CHIP8_HOT chip8_core::op_low(const decoded_op&) {
+    set_hires(false);
+    reg.PC += 2;
+}
+
+/// 00FF: Switch to 128x64 mode (SCHIP)
+void CHIP8_HOT chip8_core::op_high(const decoded_op&) {
+    set_hires(true);
+    reg.PC += 2;
+}
+
+/**
+ * @brief Switches between 64x32 and 128x64 mode.
+ *
+ * The layouts of the two modes differ, so the display is cleared and marked dirty
+ * even if the mode does not change.
+ *
+ * @param enable True for 128x64 mode.
+ */
+void CHIP8_HOT chip8_core::set_hires(bool enable) {
+    hires = enable;
+    memset(HIRES_DISPLAYBUFFER, 0, sizeof(HIRES_DISPLAYBUFFER));
+    dirty.mark_all();
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+}
+
+/// 1NNN: Jump to address NNN
+void CHIP8_HOT chip8_core::op_jp(const decoded_op& op) {
+    // A jump to itself or back to a delay timer poll cannot end before the next tick
+    if (op.arg == reg.PC) {
+        idle_loop_length = 1;
+        idle_state.store(IDLE_TICK, std::memory_order_relaxed);
+    } else if (op.arg + 4 == reg.PC && is_delay_poll(op.arg)) {
+        idle_loop_length = 3;
+        idle_poll_register = (fetch(op.arg) >> 8) & 0xF;
+        idle_state.store(IDLE_TICK, std::memory_order_relaxed);
+    }
+    reg.PC = op.arg;
+}
+
+/// 2NNN: Call subroutine at NNN
+void CHIP8_HOT chip8_core::op_call(const decoded_op& op) {
+    if (reg.SP < 16) {
+        reg.STACK[reg.SP++] = reg.PC + 2; // Push the current PC onto the stack
+        reg.PC = op.arg;                  // Jump to the address specified by the opcode
+    } else {
+        reg.PC += 2; // If stack is full, increment PC to skip this instruction
+    }
+}
+
+/// 3XNN: Skip next instruction if Vx equals NN
+void CHIP8_HOT chip8_core::op_se_nn(const decoded_op& op) {
+    reg.PC += (reg.V[op.x] == op.arg) ? 4 : 2;
+}
+
+/// 4XNN: Skip next instruction if Vx does not equal NN
+void CHIP8_HOT chip8_core::op_sne_nn(const decoded_op& op) {
+    reg.PC += (reg.V[op.x] != op.arg) ? 4 : 2;
+}
+
+/// 5XY0: Skip next instruction if Vx equals Vy
+void CHIP8_HOT chip8_core::op_se_xy(const decoded_op& op) {
+    reg.PC += (reg.V[op.x] == reg.V[op.arg]) ? 4 : 2;
+}
+
+/// 6XNN: Set Vx = NN
+void CHIP8_HOT chip8_core::op_ld_nn(const decoded_op& op) {
+    reg.V[op.x] = op.arg;
+    reg.PC += 2;
+}
+
+/// 7XNN: Set Vx = Vx + NN
+void CHIP8_HOT chip8_core::op_add_nn(const decoded_op& op) {
+    reg.V[op.x] += op.arg;
+    reg.PC += 2;
+}
+
+/// 8XY0: Set Vx = Vy
+void CHIP8_HOT chip8_core::op_ld_xy(const decoded_op& op) {
+    reg.V[op.x] = reg.V[op.arg];
+    reg.PC += 2;
+}
+
+/// 8XY1: Set Vx = Vx OR Vy (VF = 0 with vf_reset)
+template <class QUIRKS>
+inline void chip8_core::op_or(const decoded_op& op) {
+    reg.V[op.x] |= reg.V[op.arg];
+    if (QUIRKS::vf_reset) {
+        reg.V[0xF] = 0;
+    }
+    reg.PC += 2;
+}
+
+/// 8XY2: Set Vx = Vx AND Vy (VF = 0 with vf_reset)
+template <class QUIRKS>
+inline void chip8_core::op_and(const decoded_op& op) {
+    reg.V[op.x] &= reg.V[op.arg];
+    if (QUIRKS::vf_reset) {
+        reg.V[0xF] = 0;
+    }
+    reg.PC += 2;
+}
+
+/// 8XY3: Set Vx = Vx XOR Vy (VF = 0 with vf_reset)
+template <class QUIRKS>
+inline void chip8_core::op_xor(const decoded_op& op) {
+    reg.V[op.x] ^= reg.V[op.arg];
+    if (QUIRKS::vf_reset) {
+        reg.V[0xF] = 0;
+    }
+    reg.PC += 2;
+}
+
+/// 8XY4: Set Vx = Vx + Vy, set VF = carry
+void CHIP8_HOT chip8_core::op_add_xy(const decoded_op& op) {
+    uint16_t sum = reg.V[op.x] + reg.V[op.arg];
+    reg.V[0xF] = (sum > 0xFF) ? 1 : 0;
+    reg.V[op.x] = sum & 0xFF;
+    reg.PC += 2;
+}
+
+/// 8XY5: Set Vx = Vx - Vy, set VF = NOT borrow
+void CHIP8_HOT chip8_core::op_sub(const decoded_op& op) {
+    reg.V[0xF] = (reg.V[op.x] > reg.V[op.arg]) ? 1 : 0;
+    reg.V[op.x] -= reg.V[op.arg];
+    reg.PC += 2;
+}
+
+/// 8XY6: Set Vx = Vx SHR 1 (Vy SHR 1 with shift_vy), set VF = least significant bit before shift
+template <class QUIRKS>
+inline void chip8_core::op_shr(const decoded_op& op) {
+    uint8_t value = QUIRKS::shift_vy ? reg.V[op.arg] : reg.V[op.x];
+    reg.V[0xF] = (value & 0x1);
+    reg.V[op.x] = value >> 1;
+    reg.PC += 2;
+}
+
+/// 8XY7: Set Vx = Vy - Vx, set VF = NOT borrow
+void CHIP8_HOT chip8_core::op_subn(const decoded_op& op) {
+    reg.V[0xF] = (reg.V[op.arg] > reg.V[op.x]) ? 1 : 0;
+    reg.V[op.x] = reg.V[op.arg] - reg.V[op.x];
+    reg.PC += 2;
+}
+
+/// 8XYE: Set Vx = Vx SHL 1 (Vy SHL 1 with shift_vy), set VF = most significant bit before shift
+template <class QUIRKS>
+inline void chip8_core::op_shl(const decoded_op& op) {
+    uint8_t value = QUIRKS::shift_vy ? reg.V[op.arg] : reg.V[op.x];
+    reg.V[0xF] = (value & 0x80) ? 1 : 0;
+    reg.V[op.x] = value << 1;
+    reg.PC += 2;
+}
+
+/// 9XY0: Skip next instruction if Vx != Vy
+void CHIP8_HOT chip8_core::op_sne_xy(const decoded_op& op) {
+    reg.PC += (reg.V[op.x] != reg.V[op.arg]) ? 4 : 2;
+}
+
+/// ANNN: Set I = NNN
+void CHIP8_HOT chip8_core::op_ld_i(const decoded_op& op) {
+    reg.INDEX = op.arg;
+    reg.PC += 2;
+}
+
+/// BNNN: Jump to address NNN + V0 (BXNN: XNN + VX with jump_vx)
+template <class QUIRKS>
+inline void chip8_core::op_jp_v0(const decoded_op& op) {
+    reg.PC = op.arg + reg.V[QUIRKS::jump_vx ? op.arg >> 8 : 0];
+}
+
+/// CXNN: Set Vx = random byte AND NN
+void CHIP8_HOT chip8_core::op_rnd(const decoded_op& op) {
+    reg.V[op.x] = random_byte() & op.arg;
+    reg.PC += 2;
+}
+
+/// DXYN: Draw a sprite at coordinate (Vx, Vy) with width 8 pixels and height N pixels
+///
+/// Each sprite row is shifted across at most two display bytes (wrapping at column 63)
+/// and XORed in a byte at a time; a pixel was erased if a destination byte and the
+/// shifted sprite bits overlap, which sets VF.
+void CHIP8_HOT chip8_core::op_drw(const decoded_op& op) {
+    if (hires) {
+        draw_hires(op);
+        return;
+    }
+    uint8_t X = reg.V[op.x] & 63;
+    uint8_t Y = reg.V[op.arg >> 4];
+    uint8_t height = op.arg & 0x000F;
+    uint8_t left_col = X >> 3;               // Display byte holding the sprite's leftmost pixel
+    uint8_t right_col = (left_col + 1) & 7;  // Next display byte, wrapping around to column 0
+    uint8_t shift = X & 7;                   // Pixel offset of the sprite within left_col
+    uint8_t collision = 0;
+
+    for (uint8_t yline = 0; yline < height; yline++) {
+        uint8_t pixel = read(reg.INDEX + yline);
+        if (pixel == 0) {
+            continue;
+        }
+        uint8_t y_coord = (Y + yline) & 31;
+        uint8_t* row = &DISPLAYBUFFER[y_coord * 8];
+
+        uint8_t left = pixel >> shift;
+        if (left) {
+            collision |= row[left_col] & left;
+            row[left_col] ^= left;
+            dirty.mark(y_coord, left_col);
+        }
+        uint8_t right = pixel << (8 - shift);  // Zero when shift is 0
+        if (right) {
+            collision |= row[right_col] & right;
+            row[right_col] ^= right;
+            dirty.mark(y_coord, right_col);
+        }
+    }
+
+    reg.V[0xF] = collision ? 1 : 0;
+    reg.PC += 2;
+    CHIP8_PERF_COUNT(dxyn_calls, 1);
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+}
+
+/**
+ * @brief DXYN in 128x64 mode: an 8xN sprite, or a 16x16 one for DXY0 (SCHIP).
+ *
+ * The start coordinate wraps, the sprite is clipped at the right and bottom edges.
+ * Each sprite row sets one bit in up to 16 column bytes of its page; VF is 1 if any
+ * pixel was erased.
+ *
+ * @param op DXYN instruction.
+ */
+void CHIP8_HOT chip8_core::draw_hires(const decoded_op& op) {
+    const uint8_t X = reg.V[op.x] & 127;
+    const uint8_t Y = reg.V[op.arg >> 4] & 63;
+    const bool wide = (op.arg & 0x000F) == 0;
+    const uint8_t height = wide ? 16 : op.arg & 0x000F;
+    const uint8_t width = wide ? 16 : 8;
+    const uint8_t last_x = min(X + width - 1, 127);
+    const uint8_t cells = static_cast<uint8_t>((0xFF << (X >> 4)) & (0xFF >> (7 - (last_x >> 4))));
+    uint8_t collision = 0;
+
+    for (uint8_t yline = 0; yline < height && Y + yline < 64; yline++) {
+        uint16_t bits = wide ? (read(reg.INDEX + yline * 2) << 8) | read(reg.INDEX + yline * 2 + 1)
+                             : read(reg.INDEX + yline) << 8;
+        bits &= 0xFFFF << (15 - (last_x - X));  // Clip at the right edge
+        if (bits == 0) {
+            continue;
+        }
+        const uint8_t y = Y + yline;
+        const uint8_t mask = 1 << (y & 7);
+        uint8_t* column = &HIRES_DISPLAYBUFFER[(y >> 3) * 128 + X];
+        while (bits) {
+            uint8_t i = __builtin_clz(static_cast<uint32_t>(bits)) - 16;  // Leftmost remaining pixel
+            collision |= column[i] & mask;
+            column[i] ^= mask;
+            bits &= ~(0x8000 >> i);
+        }
+        dirty.mark_cells((y >> 3) * 4, cells);
+    }
+
+    reg.V[0xF] = collision ? 1 : 0;
+    reg.PC += 2;
+    CHIP8_PERF_COUNT(dxyn_calls, 1);
+    flag.set(CPU_CYCLE_DRAW_FLAG, true);
+}
+
+/// EX9E: Skip next instruction if key with the value of Vx is pressed
+void CHIP8_HOT chip8_core::op_skp(const decoded_op& op) {
+    reg.PC += is_key_pressed(reg.V[op.x]) ? 4 : 2;
+}
+
+/// EXA1: Skip next instruction if key with the value of Vx is not pressed
+void CHIP8_HOT chip8_core::op_sknp(const decoded_op& op) {
+    reg.PC += !is_key_pressed(reg.V[op.x]) ? 4 : 2;
+}
+
+/// FX07: Set Vx = delay timer value
+void CHIP8_HOT chip8_core::op_ld_x_dt(const decoded_op& op) {
+    reg.V[op.x] = reg.DELAYTIMER;
+    reg.PC += 2;
+}
+
+/// FX0A: Wait for a key press, then store the value of the key in Vx
+void CHIP8_HOT chip8_core::op_ld_key(const decoded_op& op) {
+    int8_t pressed_key = get_pressed_key();
+    if (pressed_key != -1) {
+        reg.V[op.x] = pressed_key;
+        reg.PC += 2;
+    } else {
+        // If no key is pressed, do not increment PC to wait for key press
+        idle_loop_length = 1;
+        idle_state.store(IDLE_KEY, std::memory_order_relaxed);
+    }
+}
+
+/// FX15: Set delay timer = Vx
+void CHIP8_HOT chip8_core::op_ld_dt_x(const decoded_op& op) {
+    reg.DELAYTIMER = reg.V[op.x];
+    reg.PC += 2;
+}
+
+/// FX18: Set sound timer = Vx
+void CHIP8_HOT chip8_core::op_ld_st_x(const decoded_op& op) {
+    reg.SOUNDTIMER = reg.V[op.x];
+    reg.PC += 2;
+}
+
+/// FX1E: Set I = I + Vx, set VF = carry
+void CHIP8_HOT chip8_core::op_add_i(const decoded_op& op) {
+    reg.INDEX += reg.V[op.x];
+    reg.V[0xF] = (reg.INDEX > 0xFFF) ? 1 : 0;
+    reg.INDEX &= 0xFFF;
+    reg.PC += 2;
+}
+
+/// FX29: Set I = location of sprite for digit Vx
+void CHIP8_HOT chip8_core::op_font(const decoded_op& op) {
+    reg.INDEX = 0x50 + (reg.V[op.x] * 5);
+    reg.PC += 2;
+}
+
+/// FX30: Set I = location of 10-byte font sprite for digit Vx (SCHIP)
+void CHIP8_HOT chip8_core::op_big_font(const decoded_op& op) {
+    reg.INDEX = 0xA0 + (reg.V[op.x] * 10);
+    reg.PC += 2;
+}
+
+/// FX33: Store BCD representation of Vx in memory locations I, I+1, and I+2
+void CHIP8_HOT chip8_core::op_bcd(const decoded_op& op) {
+    store(reg.INDEX, reg.V[op.x] / 100);
+    store(reg.INDEX + 1, (reg.V[op.x] / 10) % 10);
+    store(reg.INDEX + 2, reg.V[op.x] % 10);
+    reg.PC += 2;
+}
+
+/// FX55: Store registers V0 through Vx in memory starting at location I (then I += X + 1 with memory_increment)
+template <class QUIRKS>
+inline void chip8_core::op_store(const decoded_op& op) {
+    for (uint8_t reg1 = 0; reg1 <= op.x; ++reg1) {
+        store(reg.INDEX + reg1, reg.V[reg1]);
+    }
+    if (QUIRKS::memory_increment) {
+        reg.INDEX += op.x + 1;
     }
+    reg.PC += 2;
 }
+
+/// FX65: Read registers V0 through Vx from memory starting at location I (then I += X + 1 with memory_increment)
+template <class QUIRKS>
+inline void chip8_core::op_load(const decoded_op& op) {
+    for (uint8_t reg1 = 0; reg1 <= op.x; ++reg1) {
+        reg.V[reg1] = read(reg.INDEX + reg1);
+    }
+    if (QUIRKS::memory_increment) {
+        reg.INDEX += op.x + 1;
+    }
+    reg.PC += 2;
+}
+
+// CHIP8_HOT wrappers of the quirk-dependent handlers, one per profile (see CHIP8_HANDLER_TABLE)
+#define CHIP8_QUIRK_WRAPPERS(name) \
+    void CHIP8_HOT chip8_core::name##_legacy(const decoded_op& op) { name<chip8_quirks_legacy>(op); } \
+    void CHIP8_HOT chip8_core::name##_cosmac(const decoded_op& op) { name<chip8_quirks_cosmac>(op); } \
+    void CHIP8_HOT chip8_core::name##_schip(const decoded_op& op) { name<chip8_quirks_schip>(op); } \
+    void CHIP8_HOT chip8_core::name##_xochip(const decoded_op& op) { name<chip8_quirks_xochip>(op); }
+CHIP8_QUIRK_WRAPPERS(op_or)
+CHIP8_QUIRK_WRAPPERS(op_and)
+CHIP8_QUIRK_WRAPPERS(op_xor)
+CHIP8_QUIRK_WRAPPERS(op_shr)
+CHIP8_QUIRK_WRAPPERS(op_shl)
+CHIP8_QUIRK_WRAPPERS(op_jp_v0)
+CHIP8_QUIRK_WRAPPERS(op_store)
+CHIP8_QUIRK_WRAPPERS(op_load)
+#undef CHIP8_QUIRK_WRAPPERS
@@ -1,100 +1,480 @@
 #ifndef CHIP8_CORE_H
 #define CHIP8_CORE_H
 
-#include <Arduino.h>
+#include "chip8_platform.h"
 #include "flag_manager.h"
+#include "dirty_map.h"
+#include "chip8_perf.h"
 
 // Timer intervals for CPU and GPU operations
 constexpr uint32_t CPU_TIMER_INTERVAL = 2;   // CPU cycle interval in milliseconds
 constexpr uint32_t GPU_TIMER_INTERVAL = 16;  // GPU cycle interval in milliseconds
+constexpr uint32_t GPU_TIMER_INTERVAL_US = 16667;  // Exact 60Hz GPU cycle interval in microseconds
+
+// Instructions-per-frame presets for batched CPU stepping
+constexpr uint16_t CPU_IPF_LEGACY    = 0;       // One instruction per CPU_TIMER_INTERVAL (default)
+constexpr uint16_t CPU_IPF_UNLIMITED = 0xFFFF;  // Run instructions as fast as possible
+constexpr uint16_t CPU_BATCH_SIZE    = 64;      // Instructions per loop() call in unlimited mode
+constexpr uint32_t CPU_MAX_CATCHUP_FRAMES = 4;  // Most frames of instructions run at once after a stall
+
+// Predecoded instruction cache for 0x200-0xFFF (7KB); set to 0 to always decode on the fly
+#ifndef CHIP8_PREDECODE_CACHE
+  #define CHIP8_PREDECODE_CACHE 1
+#endif
+
+// Translation cache of basic blocks with fused superinstructions in front of the interpreter
+// (about 4.8KB with the defaults); set to 0 to dispatch every instruction on its own
+#ifndef CHIP8_BLOCK_CACHE
+  #define CHIP8_BLOCK_CACHE 1
+#endif
+
+// Block cache geometry: sets * ways blocks of up to CHIP8_BLOCK_MAX_OPS instructions, LRU per set
+#ifndef CHIP8_BLOCK_CACHE_SETS
+  #define CHIP8_BLOCK_CACHE_SETS 16
+#endif
+#ifndef CHIP8_BLOCK_CACHE_WAYS
+  #define CHIP8_BLOCK_CACHE_WAYS 4
+#endif
+#ifndef CHIP8_BLOCK_MAX_OPS
+  #define CHIP8_BLOCK_MAX_OPS 16
+#endif
+
+// Execute ROMs in place from flash, copying 256-byte pages into RAM only when they are written;
+// set to 1 to enable. The ROM passed to load_rom() must then stay valid while it runs.
+#ifndef CHIP8_FLASH_ROM
+  #define CHIP8_FLASH_ROM 0
+#endif
+
+// Writable RAM pages in flash ROM mode (page 0 with the font and a partial last ROM page use one each)
+#ifndef CHIP8_RAM_PAGES
+  #define CHIP8_RAM_PAGES 16
+#endif
+
+// Hot-path placement profile; set to 1 to run the interpreter loop, the instruction handlers
+// and the OLED conversion from IRAM and to keep the dispatch tables and LUTs in DRAM,
+// so flash cache misses (Wi-Fi, flash writes, a cold cache) cannot stall emulation.
+// Costs a few KB of IRAM (see the linker map); with CHIP8_PERF_STALLS the stall cycles it saves can be measured.
+#ifndef CHIP8_HOT_PATH
+  #define CHIP8_HOT_PATH 0
+#endif
+
+#if CHIP8_HOT_PATH
+  #define CHIP8_HOT IRAM_ATTR       // Code on the hot path
+  #define CHIP8_HOT_DATA DRAM_ATTR  // Read-only tables on the hot path
+#else
+  #define CHIP8_HOT
+  #define CHIP8_HOT_DATA
+#endif
+
+/**
+ * @struct chip8_registers
+ * @brief Represents the CPU registers used in CHIP-8.
+ *
+ * The registers nearly every instruction touches (PC, I, V0-VF) are grouped in the first
+ * 20 bytes; the stack and the rarely used 8-bit registers follow. 56 bytes in total.
+ */
+struct chip8_registers {
+  uint16_t PC;               ///< Program Counter
+  uint16_t INDEX;            ///< Index Register
+  uint8_t V[16];             ///< General-purpose registers (V0 to VF)
+  uint16_t STACK[16];        ///< Call stack (16 levels deep)
+  uint8_t SP;                ///< Stack Pointer
+  uint8_t DELAYTIMER;        ///< Delay timer (counts down at 60Hz)
+  uint8_t SOUNDTIMER;        ///< Sound timer (counts down at 60Hz)
+};
+
+// Identification of chip8_snapshot blobs; bump the version whenever the layout changes
+constexpr uint32_t CHIP8_SNAPSHOT_MAGIC = 0x38504843;  // "CHP8"
+constexpr uint16_t CHIP8_SNAPSHOT_VERSION = 2;
+
+/**
+ * @struct chip8_snapshot
+ * @brief Complete emulator state as one contiguous, versioned blob (5.2KB).
+ *
+ * Written by chip8_core::snapshot() and read by chip8_core::restore(). It contains no
+ * pointers, so it can be kept in RTC memory across deep sleep (RTC_NOINIT_ATTR), stored
+ * as an NVS blob or in a file, and restored in a fraction of a millisecond.
+ */
+struct chip8_snapshot {
+  uint32_t magic;            ///< CHIP8_SNAPSHOT_MAGIC
+  uint16_t version;          ///< CHIP8_SNAPSHOT_VERSION
+  uint16_t size;             ///< sizeof(chip8_snapshot)
+  uint32_t checksum;         ///< FNV-1a over the rest of the snapshot
+  uint32_t random_state;     ///< CXNN generator state (0 = hardware RNG)
+  chip8_registers registers; ///< CPU registers
+  uint8_t hires;             ///< 1 in SCHIP 128x64 mode
+  uint8_t reserved[3];       ///< Zero
+  uint8_t display[(64 * 128) / 8];  ///< Display buffer; only the first 256 bytes are used in 64x32 mode
+  uint8_t ram[4096];         ///< Memory
+};
+
+/**
+ * @brief Quirk profiles: behavior of the instructions CHIP-8 variants disagree on.
+ *
+ * Each profile is a type with one constexpr flag per quirk. The affected handlers are
+ * templates on the profile, so every flag folds away at compile time and there is one
+ * dispatch table per profile; chip8_core::set_quirks() selects the table.
+ */
+struct chip8_quirks_legacy {              // This emulator's original behavior (default)
+  static constexpr bool vf_reset = false;         ///< 8XY1/8XY2/8XY3 clear VF
+  static constexpr bool shift_vy = false;         ///< 8XY6/8XYE shift VY into VX instead of shifting VX
+  static constexpr bool memory_increment = false; ///< FX55/FX65 leave I at I + X + 1
+  static constexpr bool jump_vx = false;          ///< BXNN jumps to XNN + VX instead of NNN + V0
+};
+struct chip8_quirks_cosmac {              // Original COSMAC VIP CHIP-8
+  static constexpr bool vf_reset = true;
+  static constexpr bool shift_vy = true;
+  static constexpr bool memory_increment = true;
+  static constexpr bool jump_vx = false;
+};
+struct chip8_quirks_schip {               // SUPER-CHIP 1.1
+  static constexpr bool vf_reset = false;
+  static constexpr bool shift_vy = false;
+  static constexpr bool memory_increment = false;
+  static constexpr bool jump_vx = true;
+};
+struct chip8_quirks_xochip {              // XO-CHIP
+  static constexpr bool vf_reset = false;
+  static constexpr bool shift_vy = true;
+  static constexpr bool memory_increment = true;
+  static constexpr bool jump_vx = false;
+};
+
+// Quirk profile selected with chip8_core::set_quirks()
+enum chip8_quirk_profile : uint8_t {
+  CHIP8_QUIRKS_LEGACY,   ///< chip8_quirks_legacy
+  CHIP8_QUIRKS_COSMAC,   ///< chip8_quirks_cosmac
+  CHIP8_QUIRKS_SCHIP,    ///< chip8_quirks_schip
+  CHIP8_QUIRKS_XOCHIP,   ///< chip8_quirks_xochip
+};
+
+// Source of a streamed ROM: fills 'buffer' with up to 'length' bytes and returns the number read
+typedef size_t (*chip8_rom_reader)(void* arg, uint8_t* buffer, size_t length);
+
+// Wake-up hook of the idle detection, see chip8_core::set_wake_callback()
+typedef void (*chip8_wake_callback)(void* arg);
+
+// Sound on/off hook, see chip8_core::set_sound_callback()
+typedef void (*chip8_sound_callback)(void* arg, bool on);
 
 /**
  * @class chip8_core
  * @brief Core class for the CHIP-8 emulator, implementing the CPU, GPU, and memory management.
  *
  * This class handles all aspects of CHIP-8 emulation, including memory, timers, input,
- * and display management. It follows a singleton pattern to ensure only one instance
- * exists during runtime.
+ * and display management. getInstance() returns the default instance used by the
+ * renderer, keypad and chip8 wrapper unless they are bound to another one; further
+ * instances can be created to run several VMs, e.g. one per CPU core or an attract-mode
+ * demo next to the active game.
+ *
+ * Memory per instance is about 13.2KB: 4KB RAM (or CHIP8_RAM_PAGES * 256 bytes in flash
+ * ROM mode), 7KB predecode cache (none with CHIP8_PREDECODE_CACHE 0), 4.8KB block cache
+ * (none with CHIP8_BLOCK_CACHE 0), 2KB of display and published frame, and about
+ * 230 bytes of registers, dirty maps and state. Create
+ * instances statically or on the heap, not on a task stack. Each instance using hardware
+ * timers takes one of the ESP32's four timers.
  */
 class chip8_core {
 
   private:
 
+    // Registers come first so every handler reaches them with a short offset from 'this'
+    chip8_registers reg;  ///< CPU register instance
+
+    // Memory and display buffers
+  #if CHIP8_FLASH_ROM
+    static constexpr uint16_t RAM_PAGE_SIZE = 256;
+    static constexpr uint8_t MEMORY_PAGES = 4096 / RAM_PAGE_SIZE;
+    const uint8_t* read_pages[MEMORY_PAGES];  ///< Backing of each page: flash ROM, zero page or a RAM page
+    uint8_t* write_pages[MEMORY_PAGES];       ///< RAM page of each page, nullptr until the page is written
+    uint8_t RAM[CHIP8_RAM_PAGES][RAM_PAGE_SIZE];  ///< Pool of writable pages
+    uint8_t ram_pages_used = 0;               ///< Pages of the pool in use
+  #else
+    uint8_t RAM[4096];  ///< Main memory (4KB)
+  #endif
     /**
-     * @brief Private constructor for singleton implementation.
+     * @brief Display buffer, in the layout of the current mode.
      *
-     * Ensures that only one instance of the chip8_core class can be created.
+     * 64x32: row-major, 8 bytes per row, bit 7 = leftmost pixel. SCHIP 128x64: SSD1306
+     * page order, 8 pages of 128 column bytes, bit 0 = top pixel of the page, so a frame
+     * goes to the panel without conversion. Dirty cells of a 128x64 frame are marked in
+     * row 4 * page, column x / 16: the same 16x8 panel pixels a 64x32 cell group covers.
      */
-    chip8_core() {}
-
-    // Delete copy constructor and assignment operator to prevent copying
-    chip8_core(const chip8_core&) = delete;
-    chip8_core& operator=(const chip8_core&) = delete;
-
-    uint8_t flag_registers[16];  ///< General-purpose flag registers
+    union {
+      uint8_t DISPLAYBUFFER[(32 * 64) / 8];         ///< 64x32 display
+      uint8_t HIRES_DISPLAYBUFFER[(64 * 128) / 8];  ///< 128x64 display
+    };
+    dirty_map dirty;  ///< Tracks modified cells of the display buffer
+    bool hires = false;  ///< SCHIP 128x64 mode (00FF), cleared by 00FE and start()
 
-    // Memory and display buffers
-    uint8_t RAM[4096];  ///< Main memory (4KB)
-    uint8_t DISPLAYBUFFER[(32 * 64) / 8];  ///< Monochrome display buffer for 64x32 screen
-    uint8_t dirty_flags[32][8] = {0};  ///< Tracks modified regions of the display buffer
+    // Published frame handed to the renderer; owned by the renderer while GPU_CYCLE_DRAW_FLAG is set
+    union {
+      uint8_t FRAMEBUFFER[(32 * 64) / 8];         ///< Snapshot of DISPLAYBUFFER at the last frame boundary
+      uint8_t HIRES_FRAMEBUFFER[(64 * 128) / 8];  ///< Snapshot of HIRES_DISPLAYBUFFER
+    };
+    dirty_map frame_dirty;  ///< Cells changed since the last frame the renderer drew
+    bool frame_hires = false;  ///< The published frame is a 128x64 frame
 
     // Timer management
     unsigned long last_CPU_cycle;  ///< Timestamp of the last CPU cycle
-    unsigned long last_GPU_cycle;  ///< Timestamp of the last GPU cycle
+    unsigned long last_GPU_cycle;  ///< Timestamp of the last GPU cycle in microseconds
+
+    std::atomic<uint16_t> key_mask{0};  ///< Pressed keys, bit k = key k; written from any core or ISR
+
+    uint16_t instructions_per_frame = CPU_IPF_LEGACY;  ///< Batch size per 60Hz frame (see CPU_IPF_*)
+    uint8_t speed_multiplier = 1;  ///< Emulated frames per real 60Hz tick (see set_speed_multiplier())
 
-    uint8_t key_states[16] = {0};  ///< Stores the current state of the 16 CHIP-8 keys
+    uint32_t random_state = 0;  ///< xorshift32 state for CXNN; 0 = use the hardware RNG
 
     /**
-     * @struct STRUCT_REGISTERS
-     * @brief Represents the CPU registers used in CHIP-8.
+     * @brief Why the running program cannot make progress (see is_idle()).
      */
-    struct STRUCT_REGISTERS {
-      uint16_t PC;               ///< Program Counter
-      uint16_t INDEX;            ///< Index Register
-      alignas(2) uint16_t STACK[16];  ///< Call stack (16 levels deep)
-      uint8_t SP;                ///< Stack Pointer
-      uint8_t DELAYTIMER;        ///< Delay timer (counts down at 60Hz)
-      uint8_t SOUNDTIMER;        ///< Sound timer (counts down at 60Hz)
-      uint8_t V[16];             ///< General-purpose registers (V0 to VF)
+    enum idle_reason : uint8_t {
+      IDLE_NONE,  ///< Not idle
+      IDLE_KEY,   ///< FX0A is waiting for a key press
+      IDLE_TICK,  ///< Spinning in a loop that only a 60Hz tick can end (delay timer poll, self jump)
     };
-    STRUCT_REGISTERS reg;  ///< CPU register instance
+    std::atomic<uint8_t> idle_state{IDLE_NONE};  ///< Set by the handlers, cleared before each batch
+    uint8_t idle_loop_length = 1;  ///< Instructions in the idle loop, starting at PC
+    uint8_t idle_poll_register = 0;  ///< Register loaded by the FX07 of a delay timer poll
+    chip8_wake_callback wake_callback = nullptr;  ///< Called on a key press while waiting for one
+    void* wake_arg = nullptr;                     ///< Argument passed to wake_callback
+    chip8_sound_callback sound_callback = nullptr;  ///< Called when the SOUND flag changes
+    void* sound_arg = nullptr;                      ///< Argument passed to sound_callback
 
     // Flag manager instance to handle emulator state flags (ROM loaded, emulator state, etc.)
     flag_manager<uint16_t> flag;
+
+    // Hardware timer of this instance and the tick counters its interrupt advances
+    hw_timer_t* hw_timer = nullptr;          ///< CPU_TIMER_INTERVAL timer, if started
+    std::atomic<uint32_t> cpu_ticks{0};      ///< CPU slices elapsed and not yet executed
+    std::atomic<uint32_t> gpu_ticks{0};      ///< 60Hz ticks elapsed and not yet processed
+    uint32_t frame_accumulator = 0;          ///< Time towards the next 60Hz tick, in 1/60 us (ISR only)
+
+    /**
+     * @brief Indices into the instruction handler dispatch table.
+     */
+    enum op_index : uint8_t {
+      OP_UNDECODED,  ///< Cache slot not decoded yet (decodes, stores and dispatches)
+      OP_NOP,        ///< Unknown instruction, skipped
+      OP_SYS,        ///< 0NNN (unsupported machine code call)
+      OP_CLS,        ///< 00E0
+      OP_RET,        ///< 00EE
+      OP_EXIT,       ///< 00FD
+      OP_SCD,        ///< 00CN (SCHIP)
+      OP_SCR,        ///< 00FB (SCHIP)
+      OP_SCL,        ///< 00FC (SCHIP)
+      OP_LOW,        ///< 00FE (SCHIP)
+      OP_HIGH,       ///< 00FF (SCHIP)
+      OP_JP,         ///< 1NNN
+      OP_CALL,       ///< 2NNN
+      OP_SE_NN,      ///< 3XNN
+      OP_SNE_NN,     ///< 4XNN
+      OP_SE_XY,      ///< 5XY0
+      OP_LD_NN,      ///< 6XNN
+      OP_ADD_NN,     ///< 7XNN
+      OP_LD_XY,      ///< 8XY0
+      OP_OR,         ///< 8XY1
+      OP_AND,        ///< 8XY2
+      OP_XOR,        ///< 8XY3
+      OP_ADD_XY,     ///< 8XY4
+      OP_SUB,        ///< 8XY5
+      OP_SHR,        ///< 8XY6
+      OP_SUBN,       ///< 8XY7
+      OP_SHL,        ///< 8XYE
+      OP_SNE_XY,     ///< 9XY0
+      OP_LD_I,       ///< ANNN
+      OP_JP_V0,      ///< BNNN
+      OP_RND,        ///< CXNN
+      OP_DRW,        ///< DXYN
+      OP_SKP,        ///< EX9E
+      OP_SKNP,       ///< EXA1
+      OP_LD_X_DT,    ///< FX07
+      OP_LD_KEY,     ///< FX0A
+      OP_LD_DT_X,    ///< FX15
+      OP_LD_ST_X,    ///< FX18
+      OP_ADD_I,      ///< FX1E
+      OP_FONT,       ///< FX29
+      OP_BIG_FONT,   ///< FX30
+      OP_BCD,        ///< FX33
+      OP_STORE,      ///< FX55
+      OP_LOAD,       ///< FX65
+      OP_COUNT,
+      // Superinstructions of the block cache; never dispatched through HANDLERS
+      OP_FUSED_LD_ADD = OP_COUNT,  ///< 6XNN; 7YMM (the 7YMM decode follows in the next slot)
+      OP_FUSED_SE_JP,              ///< 3XNN; 1NNN (the 1NNN decode follows in the next slot)
+      OP_FUSED_SNE_JP,             ///< 4XNN; 1NNN (the 1NNN decode follows in the next slot)
+    };
+
+    /**
+     * @struct decoded_op
+     * @brief A decoded instruction: handler index plus pre-extracted operands.
+     *
+     * The meaning of `arg` depends on the handler: NNN for jumps and ANNN, NN for
+     * immediates, Y for register pairs, and (Y << 4) | N for DXYN.
+     */
+    struct decoded_op {
+      uint8_t handler;  ///< Index into HANDLERS (op_index)
+      uint8_t x;        ///< X register index
+      uint16_t arg;     ///< Handler-specific operand
+    };
+
+    typedef void (chip8_core::*op_handler)(const decoded_op&);
+    static constexpr uint8_t QUIRK_PROFILES = 4;  ///< Entries of chip8_quirk_profile
+    static const op_handler HANDLERS[QUIRK_PROFILES][OP_COUNT];  ///< Dispatch table per quirk profile, indexed by op_index
+    const op_handler* handlers = HANDLERS[CHIP8_QUIRKS_LEGACY];  ///< Table of the selected profile
+    chip8_quirk_profile quirks = CHIP8_QUIRKS_LEGACY;             ///< Selected profile
+  #if CHIP8_PERF
+    static const uint8_t OP_CLASS[OP_COUNT];     ///< Opcode class (first nibble, 16 = predecode miss) per handler
+  #endif
+
+  #if CHIP8_PREDECODE_CACHE
+    static constexpr uint16_t DECODE_CACHE_SLOTS = (4096 - 0x200) / 2;
+    decoded_op decode_cache[DECODE_CACHE_SLOTS];  ///< One slot per even address from 0x200 to 0xFFE
+  #endif
+
+  #if CHIP8_BLOCK_CACHE
+    /**
+     * @struct code_block
+     * @brief A translated basic block: the decoded instructions from 'pc' up to and
+     * including the first one that branches, waits or stores, with fusable pairs marked.
+     */
+    struct code_block {
+      uint16_t pc;           ///< Start address, BLOCK_EMPTY if unused
+      uint8_t length;        ///< Instructions (slots used in ops)
+      uint32_t last_used;    ///< block_clock at the last use, for LRU replacement
+      decoded_op ops[CHIP8_BLOCK_MAX_OPS];
+    };
+    static constexpr uint16_t BLOCK_EMPTY = 0xFFFF;  ///< Outside the program area, so never a block start
+    code_block blocks[CHIP8_BLOCK_CACHE_SETS * CHIP8_BLOCK_CACHE_WAYS];
+    uint32_t block_clock = 0;                          ///< Counts block lookups
+    uint32_t block_coverage[(4096 - 0x200) / 2 / 32];  ///< Bit per instruction slot in any translated block
+  #endif
     
     // Private methods for internal functionality
     void initialize();          ///< Initializes the emulator state
+    void clear_memory();        ///< Clears memory and loads the font set
+    void begin_running();       ///< Marks the emulator running and starts its timers
+    static uint32_t snapshot_checksum(const chip8_snapshot& snap);  ///< Checksum of a snapshot
     void load_fontset();        ///< Loads the CHIP-8 font set into memory
-    void gpu_cycle();           ///< Handles GPU cycles for rendering
-    void cpu_cycle();           ///< Handles CPU cycles for instruction execution
+    void gpu_cycle(bool hardware_timers);  ///< Handles GPU cycles for rendering
+    void frame_tick(uint32_t ticks, uint32_t instructions);  ///< Runs the work of elapsed 60Hz frames
+    void fast_forward(uint32_t ticks);     ///< Runs speed_multiplier frames per tick, publishing the last
+    void tick_timers(uint32_t ticks);      ///< Decrements the delay and sound timers
+    void publish_frame();       ///< Copies the display buffer into the published frame
+    void set_hires(bool enable);  ///< Switches between 64x32 and 128x64 mode, clearing the display
+    void draw_hires(const decoded_op& op);  ///< DXYN/DXY0 in 128x64 mode
+    void cpu_cycle(bool hardware_timers);  ///< Handles CPU cycles for instruction execution
+    void run_batch(uint32_t count);        ///< Executes a batch of instructions back to back
     void execute();             ///< Decodes and executes CHIP-8 instructions
+    static decoded_op decode(uint16_t opcode);  ///< Translates an opcode into a decoded_op
+    uint8_t read(uint16_t address);             ///< Reads a byte of memory (wraps at 4KB)
+    uint16_t fetch(uint16_t address);           ///< Reads the big-endian opcode at address
+    void store(uint16_t address, uint8_t value);  ///< Writes RAM, invalidating any cached decode
+  #if CHIP8_FLASH_ROM
+    uint8_t* copy_page(uint8_t page);           ///< Gives a page a RAM copy (copy-on-write)
+  #endif
+    void predecode_all();       ///< Decodes the whole program area into the cache
+  #if CHIP8_BLOCK_CACHE
+    uint32_t run_block(uint32_t max_instructions);  ///< Runs the translated block at PC
+    code_block& find_block(uint16_t pc);            ///< Looks up or translates the block at pc
+    void translate(code_block& block, uint16_t pc); ///< Translates the basic block at pc
+    void cover_block_slots(uint16_t address);       ///< Marks an instruction's memory as translated
+    void flush_blocks();                            ///< Drops all translated blocks
+    static bool ends_block(uint8_t handler);        ///< Checks if an instruction ends a basic block
+  #endif
+
+    // Instruction handlers (see op_index). A quirk-dependent handler is an inlined template
+    // on the profile plus one CHIP8_HOT wrapper per profile for the dispatch tables, because
+    // GCC ignores section attributes on template instantiations.
+  #define CHIP8_QUIRK_HANDLER(name) \
+    template <class QUIRKS> __attribute__((always_inline)) inline void name(const decoded_op& op); \
+    void name##_legacy(const decoded_op& op); \
+    void name##_cosmac(const decoded_op& op); \
+    void name##_schip(const decoded_op& op); \
+    void name##_xochip(const decoded_op& op)
+    void op_undecoded(const decoded_op& op);
+    void op_nop(const decoded_op& op);
+    void op_sys(const decoded_op& op);
+    void op_cls(const decoded_op& op);
+    void op_ret(const decoded_op& op);
+    void op_exit(const decoded_op& op);
+    void op_scd(const decoded_op& op);
+    void op_scr(const decoded_op& op);
+    void op_scl(const decoded_op& op);
+    void op_low(const decoded_op& op);
+    void op_high(const decoded_op& op);
+    void op_jp(const decoded_op& op);
+    void op_call(const decoded_op& op);
+    void op_se_nn(const decoded_op& op);
+    void op_sne_nn(const decoded_op& op);
+    void op_se_xy(const decoded_op& op);
+    void op_ld_nn(const decoded_op& op);
+    void op_add_nn(const decoded_op& op);
+    void op_ld_xy(const decoded_op& op);
+    CHIP8_QUIRK_HANDLER(op_or);
+    CHIP8_QUIRK_HANDLER(op_and);
+    CHIP8_QUIRK_HANDLER(op_xor);
+    void op_add_xy(const decoded_op& op);
+    void op_sub(const decoded_op& op);
+    CHIP8_QUIRK_HANDLER(op_shr);
+    void op_subn(const decoded_op& op);
+    CHIP8_QUIRK_HANDLER(op_shl);
+    void op_sne_xy(const decoded_op& op);
+    void op_ld_i(const decoded_op& op);
+    CHIP8_QUIRK_HANDLER(op_jp_v0);
+    void op_rnd(const decoded_op& op);
+    void op_drw(const decoded_op& op);
+    void op_skp(const decoded_op& op);
+    void op_sknp(const decoded_op& op);
+    void op_ld_x_dt(const decoded_op& op);
+    void op_ld_key(const decoded_op& op);
+    void op_ld_dt_x(const decoded_op& op);
+    void op_ld_st_x(const decoded_op& op);
+    void op_add_i(const decoded_op& op);
+    void op_font(const decoded_op& op);
+    void op_big_font(const decoded_op& op);
+    void op_bcd(const decoded_op& op);
+    CHIP8_QUIRK_HANDLER(op_store);
+    CHIP8_QUIRK_HANDLER(op_load);
+  #undef CHIP8_QUIRK_HANDLER
     int8_t get_pressed_key();   ///< Gets the currently pressed key
+    uint8_t random_byte();      ///< Returns the next random byte for CXNN
+    bool is_delay_poll(uint16_t address);  ///< Checks for "FX07; 3XNN/4XNN" at address
+    void notify_key_press();    ///< Runs the wake callback if FX0A is waiting
+    void set_sound(bool on);    ///< Updates the SOUND flag and reports edges to the sound callback
 
     // Timer utility methods
-    bool cpu_timer_flag();       ///< Checks if the CPU timer interval has elapsed
-    bool gpu_timer_flag();       ///< Checks if the GPU timer interval has elapsed
-    void reset_cpu_timer_flag(); ///< Resets the CPU timer flag
-    void reset_gpu_timer_flag(); ///< Resets the GPU timer flag
+    uint32_t take_cpu_ticks();   ///< Returns and clears the elapsed CPU slices
+    uint32_t take_gpu_ticks();   ///< Returns and clears the elapsed 60Hz ticks
 
     // Hardware timer controls
-    void ht_start(); ///< Starts hardware timers
-    void ht_stop();  ///< Stops hardware timers
+    void ht_start(); ///< Starts the hardware timer
+    void ht_stop();  ///< Stops the hardware timer
+    static void on_timer(void* arg);  ///< Timer interrupt, arg is the instance
 
   public:
 
+    chip8_core() {}
+
+    // Delete copy constructor and assignment operator to prevent copying
+    chip8_core(const chip8_core&) = delete;
+    chip8_core& operator=(const chip8_core&) = delete;
+
     /**
-     * @brief Provides access to the singleton instance of chip8_core.
+     * @brief Provides access to the default instance of chip8_core.
      * 
-     * @return Reference to the chip8_core singleton instance.
+     * @return Reference to the default chip8_core instance.
      */
     static chip8_core& getInstance() {
-      static chip8_core instance;  ///< Ensures only one instance exists
+      static chip8_core instance;  ///< Default instance, created on first use
       return instance;
     }
 
     // Public interface for display and control
-    uint8_t* get_display_buffer();  ///< Returns a pointer to the display buffer
-    uint8_t (*get_dirty_flags())[8] { return dirty_flags; }  ///< Returns the dirty flags array
+    uint8_t* get_display_buffer();  ///< Returns a pointer to the published frame buffer
+    bool is_hires();  ///< Checks if the published frame is a 128x64 SCHIP frame
+    dirty_map& get_dirty_map() { return frame_dirty; }  ///< Returns the published frame's dirty cells
 
     // Emulator control methods
     bool start();  ///< Starts the emulator if a ROM is loaded
@@ -103,12 +483,39 @@ class chip8_core {
     void loop();  ///< Main loop for managing CPU and GPU cycles
     bool is_running();  ///< Returns true if the emulator is currently running
     bool sound();  ///< Checks if the sound timer is active
-    void reset_draw();  ///< Resets the draw flag after rendering a frame
-    bool need_to_draw();  ///< Checks if a new frame needs to be drawn
+    void set_sound_callback(chip8_sound_callback callback, void* arg);  ///< Sets the sound on/off hook
+    void reset_draw();  ///< Hands the published frame back to the core after rendering it
+    void skip_frame();  ///< Hands the published frame back undrawn, merging it into the next one
+    bool need_to_draw();  ///< Checks if a new frame has been published for drawing
     void load_rom(const uint8_t* rom, const size_t rom_size);  ///< Loads a ROM into memory
+    bool load_rom(chip8_rom_reader reader, void* arg, size_t rom_size);  ///< Streams a ROM into memory
     void set_key_state(uint8_t key, bool is_pressed);  ///< Updates the state of a specific key
+    void set_key_mask(uint16_t mask);  ///< Updates all 16 keys at once (bit k = key k)
+    uint16_t get_key_mask();  ///< Returns all 16 key states (bit k = key k)
     bool is_key_pressed(uint8_t key);  ///< Checks if a specific key is currently pressed
     void enable_hardware_timers();  ///< Enables hardware timers for timing CPU/GPU cycles
+    void set_instructions_per_frame(uint16_t ipf);  ///< Selects legacy, batched or unlimited CPU stepping
+    uint16_t get_instructions_per_frame();  ///< Returns the current instructions-per-frame setting
+    void set_speed_multiplier(uint8_t multiplier);  ///< Runs the emulation at a multiple of real time
+    uint8_t get_speed_multiplier();  ///< Returns the current speed multiplier
+
+    // Deterministic replay
+    void set_random_seed(uint32_t seed);  ///< Makes CXNN reproducible (0 = hardware RNG)
+    void step_frame(uint16_t instructions);  ///< Runs one 60Hz frame independent of the clock
+    uint64_t frame_hash();  ///< Hashes the display buffer and registers
+
+    // Compatibility
+    void set_quirks(chip8_quirk_profile profile);  ///< Selects the quirk profile of the current ROM
+    chip8_quirk_profile get_quirks();              ///< Returns the selected quirk profile
+
+    // Suspend and resume
+    void snapshot(chip8_snapshot& out);  ///< Saves the complete emulator state
+    bool restore(const chip8_snapshot& in);  ///< Resumes from a saved state
+
+    // Idle detection
+    bool is_idle();  ///< Checks if the program is waiting for a key press or the next 60Hz tick
+    uint32_t idle_time_us();  ///< Returns how long the caller may sleep, 0 if not idle
+    void set_wake_callback(chip8_wake_callback callback, void* arg);  ///< Sets the key press wake-up hook
 };
 
 #endif  // CHIP8_CORE_H
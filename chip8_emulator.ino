@@ -1,17 +1,95 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Adafruit_SSD1306.h>
+#include <atomic>
 
 // Define SSD1306 OLED I2C address
 #define SSD1306OLED 0x3C
 #define MENU_ENABLED
 
+// Number of CHIP-8 instructions executed per 60Hz frame (CPU_IPF_LEGACY for one per 2 ms)
+#define INSTRUCTIONS_PER_FRAME 12
+
+// Render the OLED from a task on the other core so I2C transfers don't stall the CPU
+#define DUAL_CORE_RENDERING
+
+// Alternatively, convert frames in the emulator loop and only flush them from a background task
+//#define ASYNC_DISPLAY_FLUSH
+
+// Sleep while the game waits for a key or the delay timer instead of busy-polling
+#define SLEEP_WHEN_IDLE
+
+// Read the CHIP-8 keys from the GPIO pins in gpio_keypad.h, scanned and debounced from a timer
+//#define GPIO_KEYPAD
+
+// Keep the last seconds of a game in RAM (about 42KB of DRAM, see rewind_buffer.h); hold the left menu button during a game to rewind
+//#define REWIND
+
+// Hold the right menu button during a game to run it at this multiple of real time
+//#define FAST_FORWARD 4
+
+// List the ROM files in /roms on LittleFS (indexed in NVS by rom_catalog.h) instead of the ROMs in roms.h
+//#define ROM_CATALOG
+
+// Play the sound timer on a passive buzzer at BEEPER_PIN (LEDC PWM, see beeper.h for frequency and volume)
+//#define BEEPER
+#define BEEPER_PIN 25
+
+// Mirror the screen over Wi-Fi as delta-encoded UDP packets (frame_streamer.h) to STREAM_RECEIVER
+//#define FRAME_STREAM
+#define WIFI_SSID "cabinet"
+#define WIFI_PASSWORD "password"
+#define STREAM_RECEIVER IPAddress(192, 168, 1, 255)  // A monitor, or the subnet broadcast address
+
+// Add a benchmark entry after the ROMs in the menu (bench_runner.h); needs CHIP8_PERF=1 in the build flags
+//#define BENCHMARK
+
 #include "chip8.h"
+#ifdef ROM_CATALOG
+#include <LittleFS.h>
+#include "rom_catalog.h"
+#else
 #include "roms.h"
+#endif
+#ifdef GPIO_KEYPAD
+#include "gpio_keypad.h"
+#endif
+#if defined(REWIND) && defined(MENU_ENABLED)
+#include "rewind_buffer.h"
+#endif
+#ifdef BEEPER
+#include "beeper.h"
+#endif
+#ifdef FRAME_STREAM
+#include "frame_streamer.h"
+#endif
+#if defined(BENCHMARK) && defined(MENU_ENABLED)
+#include "bench_runner.h"
+#endif
 
 // Instantiate the CHIP-8 emulator
 chip8 ch8;
 
+#ifdef GPIO_KEYPAD
+gpio_keypad keypad;
+#endif
+
+#ifdef BEEPER
+beeper buzzer;
+#endif
+
+#ifdef FRAME_STREAM
+frame_streamer streamer;
+#endif
+
+#if defined(REWIND) && defined(MENU_ENABLED)
+rewind_buffer rewind_history;
+uint32_t last_rewind_ms = 0;  // Time of the last rewind step while the button is held
+#endif
+
+#ifdef ROM_CATALOG
+rom_catalog catalog;
+#else
 // List of ROM names available for selection
 const char* rom_names[] = {
     "Space Invaders",
@@ -30,10 +108,28 @@ const size_t rom_sizes[] = {
     sizeof(glitch_ghost),
 };
 
+// Quirk profile each ROM expects
+const chip8_quirk_profile rom_quirks[] = {
+    CHIP8_QUIRKS_LEGACY,
+    CHIP8_QUIRKS_LEGACY,
+};
+#endif
+
 #ifdef MENU_ENABLED
 
 // Total number of ROMs available
+#ifdef ROM_CATALOG
+size_t num_roms = 0;  // Set from the catalog in setup()
+#else
 const size_t num_roms = sizeof(rom_names) / sizeof(rom_names[0]);
+#endif
+
+// Menu entries after the ROMs: the benchmark, if enabled
+#ifdef BENCHMARK
+const size_t extra_entries = 1;
+#else
+const size_t extra_entries = 0;
+#endif
 
 // Index of the currently selected ROM
 size_t selected_rom_index = 0;
@@ -43,6 +139,36 @@ const int button_left_pin = 14;    // Left navigation button
 const int button_right_pin = 12;   // Right navigation button
 const int button_select_pin = 13;  // Select button
 
+// Edges within this time after a registered press are contact bounce
+const uint32_t button_debounce_ms = 50;
+
+// Button press events, one bit per button, set by the button interrupts
+enum : uint8_t {
+    BUTTON_LEFT = 1 << 0,
+    BUTTON_RIGHT = 1 << 1,
+    BUTTON_SELECT = 1 << 2,
+};
+std::atomic<uint8_t> button_events{0};
+volatile uint32_t button_last_press_ms[3] = {0};
+volatile bool menu_active = false;     // Button presses wake the menu only while it is shown
+TaskHandle_t menu_task = nullptr;      // Task running loop(), woken by button presses
+
+// ROM names split into display lines once at startup
+const int max_chars_per_line = 8;  // Maximum characters per line at text size 2
+const int max_lines = 3;           // Maximum number of lines to display
+struct rom_label {
+    char lines[max_lines][max_chars_per_line + 1];
+    uint8_t count;
+};
+#ifdef ROM_CATALOG
+rom_label selected_label;  // Label of the selected catalog entry, split when the menu is redrawn
+#else
+rom_label rom_labels[num_roms + extra_entries];
+#endif
+
+// Menu has to be redrawn (selection changed or a game used the display)
+bool menu_dirty = true;
+
 #endif
 
 /**
@@ -54,6 +180,29 @@ void setup() {
 
     // Initialize the CHIP-8 emulator
     ch8.setup();
+    ch8.set_instructions_per_frame(INSTRUCTIONS_PER_FRAME);
+#ifdef DUAL_CORE_RENDERING
+    ch8.set_dual_core(true);
+#endif
+#ifdef ASYNC_DISPLAY_FLUSH
+    ch8.set_async_flush(true);
+#endif
+#ifdef SLEEP_WHEN_IDLE
+    ch8.set_sleep_when_idle(true);
+#endif
+#ifdef GPIO_KEYPAD
+    keypad.setup();
+    keypad.begin_scan();
+#endif
+#ifdef BEEPER
+    buzzer.begin(ch8.get_core(), BEEPER_PIN);
+#endif
+#ifdef FRAME_STREAM
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);  // Connects in the background; packets before that are dropped
+    streamer.begin(STREAM_RECEIVER);
+    ch8.set_frame_callback(&frame_streamer::on_frame, &streamer);
+#endif
 
 #ifdef MENU_ENABLED
     // Configure button pins as inputs with internal pull-up resistors
@@ -61,8 +210,32 @@ void setup() {
     pinMode(button_right_pin, INPUT_PULLUP);
     pinMode(button_select_pin, INPUT_PULLUP);
 
-    // Display the initial ROM selection screen
-    display_rom();
+    // Report presses from falling edges instead of polling the pins
+    menu_task = xTaskGetCurrentTaskHandle();
+    attachInterruptArg(digitalPinToInterrupt(button_left_pin), button_isr, (void*)BUTTON_LEFT, FALLING);
+    attachInterruptArg(digitalPinToInterrupt(button_right_pin), button_isr, (void*)BUTTON_RIGHT, FALLING);
+    attachInterruptArg(digitalPinToInterrupt(button_select_pin), button_isr, (void*)BUTTON_SELECT, FALLING);
+
+#ifndef ROM_CATALOG
+    // Split the ROM names into display lines once
+    for (size_t i = 0; i < num_roms; i++) {
+        split_rom_name(rom_names[i], rom_labels[i]);
+    }
+#ifdef BENCHMARK
+    split_rom_name("Benchmark", rom_labels[num_roms]);
+#endif
+#endif
+#endif
+
+#ifdef ROM_CATALOG
+    // Index the ROM files; only scans the directory if it changed since the last boot
+    if (LittleFS.begin() && catalog.begin(LittleFS, LittleFS.usedBytes())) {
+    #ifdef MENU_ENABLED
+        num_roms = catalog.count();
+    #endif
+    } else {
+        Serial.println(F("ROM catalog unavailable"));
+    }
 #endif
 }
 
@@ -70,6 +243,67 @@ void setup() {
 // Variable to keep track of scroll position (unused but can be extended for scrolling functionality)
 size_t scroll_offset = 0;
 
+/**
+ * @brief Interrupt handler of the navigation buttons.
+ *
+ * Records a press of the button given in 'arg' unless it is bounce of the previous one,
+ * and wakes the menu if it is shown.
+ *
+ * @param arg The button's BUTTON_* bit.
+ */
+void IRAM_ATTR button_isr(void* arg) {
+    uint8_t button = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(arg));
+    uint8_t index = __builtin_ctz(button);
+    uint32_t now = millis();
+    if (now - button_last_press_ms[index] < button_debounce_ms) {
+        return;
+    }
+    button_last_press_ms[index] = now;
+    button_events.fetch_or(button, std::memory_order_relaxed);
+    if (menu_active && menu_task != nullptr) {
+        BaseType_t higher_priority_woken = pdFALSE;
+        vTaskNotifyGiveFromISR(menu_task, &higher_priority_woken);
+        portYIELD_FROM_ISR(higher_priority_woken);
+    }
+}
+
+/**
+ * @brief Splits a ROM name into centered display lines.
+ *
+ * Words are separated by spaces; a word longer than max_chars_per_line is broken up.
+ * At most max_lines lines are kept.
+ *
+ * @param name ROM name to split.
+ * @param label Receives the lines and their count.
+ */
+void split_rom_name(const char* name, rom_label& label) {
+    label.count = 0;
+    int length = 0; // Characters in the line being built
+
+    for (const char* c = name; *c != '\0' && label.count < max_lines; c++) {
+        // Spaces end the current line
+        if (*c == ' ') {
+            if (length > 0) {
+                label.lines[label.count++][length] = '\0';
+                length = 0;
+            }
+            continue;
+        }
+
+        // Add the character, starting a new line once the limit is reached
+        label.lines[label.count][length++] = *c;
+        if (length >= max_chars_per_line) {
+            label.lines[label.count++][length] = '\0';
+            length = 0;
+        }
+    }
+
+    // Add any remaining text as the last line
+    if (length > 0 && label.count < max_lines) {
+        label.lines[label.count++][length] = '\0';
+    }
+}
+
 /**
  * @brief Displays the currently selected ROM on the OLED screen.
  */
@@ -84,74 +318,28 @@ void display_rom() {
     oled1.setTextSize(2);              // Set text size to 2x
     oled1.setTextColor(SSD1306_WHITE); // Set text color to white
 
-    // Retrieve the name of the selected ROM
-    String rom_name = rom_names[selected_rom_index];
-
-    // Variables for splitting the ROM name into multiple lines
-    const int maxCharsPerLine = 8; // Maximum characters per line (excluding spaces)
-    const int maxLines = 3;        // Maximum number of lines to display
-    String lines[maxLines];        // Array to hold the split lines
-    int currentLineIndex = 0;      // Index of the current line being processed
-
-    String currentLine = "";       // Temporary string to build each line
-    int charCount = 0;             // Character count for the current line
-
-    // Loop through each character in the ROM name to split it into lines
-    for (int i = 0; i < rom_name.length(); i++) {
-        char currentChar = rom_name[i];
-
-        // Check for space character to handle word breaks
-        if (currentChar == ' ') {
-            if (!currentLine.isEmpty()) {
-                // Save the current line and reset counters
-                lines[currentLineIndex++] = currentLine;
-                currentLine = "";
-                charCount = 0;
-
-                // Break if maximum number of lines is reached
-                if (currentLineIndex >= maxLines) {
-                    break;
-                }
-            }
-            continue; // Skip adding the space to the line
-        }
-
-        // Add the character to the current line
-        currentLine += currentChar;
-        charCount++;
-
-        // Start a new line if character limit is reached
-        if (charCount >= maxCharsPerLine) {
-            lines[currentLineIndex++] = currentLine;
-            currentLine = "";
-            charCount = 0;
-
-            // Break if maximum number of lines is reached
-            if (currentLineIndex >= maxLines) {
-                break;
-            }
-        }
-    }
-
-    // Add any remaining text as the last line
-    if (currentLineIndex < maxLines && currentLine.length() > 0) {
-        lines[currentLineIndex++] = currentLine;
-    }
-
     // Calculate vertical starting position to vertically center the text
-    int totalLines = currentLineIndex;                   // Total number of lines to display
-    int startY = (64 - (totalLines * 16)) / 2;           // 64 is the display height; 16 is the line height
+#ifdef ROM_CATALOG
+    rom_entry entry;
+    if (extra_entries != 0 && selected_rom_index == num_roms) {
+        split_rom_name("Benchmark", selected_label);
+    } else {
+        split_rom_name(catalog.get(selected_rom_index, entry) ? entry.name : "No ROMs", selected_label);
+    }
+    const rom_label& label = selected_label;
+#else
+    const rom_label& label = rom_labels[selected_rom_index];
+#endif
+    int startY = (64 - (label.count * 16)) / 2;          // 64 is the display height; 16 is the line height
 
     // Iterate over each line to display it on the screen
-    for (int i = 0; i < totalLines; i++) {
-        String lineText = lines[i];
-
+    for (int i = 0; i < label.count; i++) {
         // Calculate horizontal position to center the text
-        int16_t textWidth = lineText.length() * 12;      // Approximate character width at text size 2
+        int16_t textWidth = strlen(label.lines[i]) * 12; // Approximate character width at text size 2
         int16_t startX = (128 - textWidth) / 2;          // 128 is the display width
 
         oled1.setCursor(startX, startY + (i * 16));      // Set cursor position for the line
-        oled1.print(lineText);                           // Print the line text
+        oled1.print(label.lines[i]);                     // Print the line text
     }
 
     // Draw navigation arrows for left and right navigation
@@ -160,8 +348,10 @@ void display_rom() {
 
     // Display the ROM position indicator (e.g., "1/2") at the bottom-right corner
     oled1.setTextSize(1);  // Set text size to 1x for smaller text
-    String rom_position = String(selected_rom_index + 1) + "/" + String(num_roms);
-    oled1.setCursor(128 - (rom_position.length() * 6), 64 - 8);  // Adjust cursor for text width and display height
+    char rom_position[12];
+    int position_length = snprintf(rom_position, sizeof(rom_position), "%u/%u",
+                                   (unsigned)(selected_rom_index + 1), (unsigned)(num_roms + extra_entries));
+    oled1.setCursor(128 - (position_length * 6), 64 - 8);  // Adjust cursor for text width and display height
     oled1.print(rom_position);
 
     // Update the OLED display with the new content
@@ -171,53 +361,120 @@ void display_rom() {
 #endif
 #endif
 
+#ifdef ROM_CATALOG
+/**
+ * @brief Streams a catalog ROM into the emulator, reporting a failure on the serial port.
+ *
+ * @param index Catalog index of the ROM.
+ * @return True if the ROM was loaded and can be started.
+ */
+bool load_catalog_rom(uint16_t index) {
+    if (catalog.load(index, ch8.get_core())) {
+        return true;
+    }
+    rom_entry entry;
+    Serial.print(F("Cannot load ROM "));
+    Serial.println(catalog.get(index, entry) ? entry.file : "(not in catalog)");
+    return false;
+}
+#endif
+
 /**
  * @brief Arduino main loop function, runs repeatedly after setup().
  */
 void loop() {
 #ifdef MENU_ENABLED
-    // Continuously display the current ROM selection
-    display_rom();
+    // Redraw the ROM selection only when it changed
+    if (menu_dirty) {
+        display_rom();
+        menu_dirty = false;
+    }
 
-    // Handle left navigation button press (active LOW)
-    if (digitalRead(button_left_pin) == LOW) {
-        if (selected_rom_index > 0) {
-            selected_rom_index--;  // Move selection to the previous ROM
-            delay(200);            // Debounce delay to prevent multiple triggers
-        }
+    // Sleep until a button is pressed
+    menu_active = true;
+    uint8_t events = button_events.exchange(0, std::memory_order_relaxed);
+    if (events == 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        events = button_events.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Handle left navigation button press
+    if ((events & BUTTON_LEFT) && selected_rom_index > 0) {
+        selected_rom_index--;  // Move selection to the previous ROM
+        menu_dirty = true;
+    }
+
+    // Handle right navigation button press
+    if ((events & BUTTON_RIGHT) && selected_rom_index + 1 < num_roms + extra_entries) {
+        selected_rom_index++;  // Move selection to the next ROM
+        menu_dirty = true;
     }
 
-    // Handle right navigation button press (active LOW)
-    if (digitalRead(button_right_pin) == LOW) {
-        if (selected_rom_index < num_roms - 1) {
-            selected_rom_index++;  // Move selection to the next ROM
-            delay(200);            // Debounce delay to prevent multiple triggers
+#ifdef BENCHMARK
+    // Handle select button press on the benchmark entry: run the suite, keep the result until a press
+    if ((events & BUTTON_SELECT) && selected_rom_index == num_roms) {
+        menu_active = false;
+        bench_runner::run(ch8, Serial);
+        button_events.store(0, std::memory_order_relaxed);
+        menu_active = true;
+        while (button_events.exchange(0, std::memory_order_relaxed) == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         }
+        menu_dirty = true;
     }
+#endif
 
-    // Handle select button press to load and play the selected ROM (active LOW)
-    if (digitalRead(button_select_pin) == LOW) {
-        delay(200); // Debounce delay to avoid accidental re-selection
+    // Handle select button press to load and play the selected ROM
+    if ((events & BUTTON_SELECT) && selected_rom_index < num_roms) {
+        menu_active = false;
 
+    #ifdef ROM_CATALOG
+        // Stream the selected ROM into the emulator; play_game() then starts the loaded ROM
+        size_t rom_size = 0;
+        const uint8_t* rom = nullptr;
+        bool rom_loaded = load_catalog_rom(selected_rom_index);  // Back to the menu if it failed
+    #else
         // Retrieve the size and data pointer of the selected ROM
         size_t rom_size = rom_sizes[selected_rom_index];
         const uint8_t* rom = rom_data[selected_rom_index];
+        bool rom_loaded = true;
+        ch8.get_core().set_quirks(rom_quirks[selected_rom_index]);
+    #endif
 
         // Enable hardware timers for the emulator
         bool enable_hardware_timers = true;
 
+    #if defined(REWIND) && defined(MENU_ENABLED)
+        rewind_history.clear();  // Start the new game without history
+    #endif
+
         // Run the selected ROM using the CHIP-8 emulator
-        while (ch8.play_game(rom, rom_size, loop_extended, enable_hardware_timers)) {
+        while (rom_loaded && ch8.play_game(rom, rom_size, loop_extended, enable_hardware_timers)) {
             // The emulator is actively running the game
         }
 
-        // After the game ends, return to the ROM selection menu
-        delay(500); // Small delay to prevent immediate re-selection
+    #if defined(FAST_FORWARD) && defined(MENU_ENABLED)
+        ch8.set_fast_forward(1);  // Don't carry a held fast-forward into the next game
+    #endif
+
+        // After the game ends, return to the ROM selection menu; presses during the game don't count
+        button_events.store(0, std::memory_order_relaxed);
+        menu_dirty = true;
     }
 #else
     // If MENU_ENABLED is not defined, automatically start the emulator with a default ROM
+#ifdef ROM_CATALOG
+    size_t rom_size = 0;                // Default to the first ROM of the catalog
+    const uint8_t* rom = nullptr;
+    if (!load_catalog_rom(0)) {
+        delay(1000);  // Retry on the next loop(), without flooding the serial port
+        return;
+    }
+#else
     size_t rom_size = rom_sizes[1];     // Default to the second ROM in the list
     const uint8_t* rom = rom_data[1];   // Pointer to the default ROM data
+    ch8.get_core().set_quirks(rom_quirks[1]);
+#endif
 
     bool enable_hardware_timers = true; // Enable hardware timers for the emulator
 
@@ -238,4 +495,39 @@ void loop() {
 void loop_extended() {
     // Placeholder for extended functionality during emulator execution
     // This function can be expanded to include additional features
+
+#ifdef GPIO_KEYPAD
+    // Keys are scanned from a timer; this only prints debug output if enabled
+    keypad.handle_keys();
+#endif
+
+#if defined(REWIND) && defined(MENU_ENABLED)
+    // Step back one rewind point per interval while the left button is held, record otherwise
+    if (digitalRead(button_left_pin) == LOW) {
+        if (millis() - last_rewind_ms >= REWIND_INTERVAL_MS) {
+            last_rewind_ms = millis();
+            rewind_history.rewind(ch8.get_core());
+        }
+    } else {
+        rewind_history.update(ch8.get_core());
+    }
+#endif
+
+#if defined(FAST_FORWARD) && defined(MENU_ENABLED)
+    // Fast-forward while the right button is held
+    ch8.set_fast_forward(digitalRead(button_right_pin) == LOW ? FAST_FORWARD : 1);
+#endif
+
+#if CHIP8_PERF
+    // Print the performance counters when 'p' is received on the serial port
+    if (Serial.available() && Serial.read() == 'p') {
+        chip8_perf::getInstance().report(Serial);
+    #if defined(REWIND) && defined(MENU_ENABLED)
+        rewind_history.report(Serial);
+    #endif
+    #ifdef FRAME_STREAM
+        streamer.report(Serial);
+    #endif
+    }
+#endif
 }
@@ -0,0 +1,248 @@
+#ifndef CHIP8_PERF_H
+#define CHIP8_PERF_H
+
+#include "chip8_platform.h"
+
+// Performance counters; set to 1 to enable. When 0 every CHIP8_PERF_* macro expands to nothing.
+#ifndef CHIP8_PERF
+  #define CHIP8_PERF 0
+#endif
+
+// Also count pipeline stall cycles with the Xtensa performance monitor; set to 1 to enable.
+// On the ESP32 these are almost all flash and PSRAM cache misses, so they show what the
+// CHIP8_HOT_PATH placement (or moving any other table) actually saves.
+#ifndef CHIP8_PERF_STALLS
+  #define CHIP8_PERF_STALLS 0
+#endif
+
+// Stall causes counted, as XTPERF_CNT_I_STALL / XTPERF_CNT_D_STALL masks
+#ifndef CHIP8_PERF_FETCH_STALL_MASK
+  #define CHIP8_PERF_FETCH_STALL_MASK (XTPERF_MASK_I_STALL_CACHE_MISS | XTPERF_MASK_I_STALL_BUSY | XTPERF_MASK_I_STALL_IN_PIF)
+#endif
+#ifndef CHIP8_PERF_DATA_STALL_MASK
+  #define CHIP8_PERF_DATA_STALL_MASK (XTPERF_MASK_D_STALL_CACHE_MISS | XTPERF_MASK_D_STALL_BUSY | XTPERF_MASK_D_STALL_IN_PIF)
+#endif
+
+#if CHIP8_PERF
+
+#if CHIP8_PERF_STALLS
+  #ifndef __XTENSA__
+    #error "CHIP8_PERF_STALLS needs the Xtensa performance monitor (ESP32, ESP32-S2, ESP32-S3)"
+  #endif
+  #include "perfmon.h"
+#endif
+
+/**
+ * @class chip8_perf
+ * @brief Cycle-counter based performance counters for the emulator, the renderer and the sketch.
+ *
+ * Counts instructions per opcode class (first nibble, plus predecode misses), DXYN calls,
+ * published, rendered and skipped frames, I2C bytes and block cache translations, and
+ * accumulates cycles spent in instruction execution, rendering and the sketch's loop
+ * callback. Per-frame execution and render times are binned into histograms, and 60Hz
+ * frame boundaries that were reached late (a tick was processed after the next one was
+ * already due) count as missed deadlines.
+ * Intended for tuning instructions-per-frame and catching regressions on new boards.
+ *
+ * With CHIP8_PERF_STALLS, execution and rendering also accumulate the instruction fetch
+ * and data stall cycles of the core they run on, and the execution stalls of each 60Hz
+ * frame are binned like its execution time. The performance monitor is per core, so it is
+ * started by the first measurement on each core; in dual-core mode the render task on
+ * core 0 and the emulator loop on core 1 each read their own counters.
+ */
+class chip8_perf {
+  public:
+    static constexpr uint8_t OPCODE_CLASSES = 17;  ///< 0x0___-0xF___ plus predecode misses
+    static constexpr uint8_t HISTOGRAM_BINS = 8;   ///< Buckets per timing histogram
+
+    /**
+     * @brief Upper bucket limits of the timing histograms in microseconds (last bucket is open).
+     */
+    static constexpr uint32_t HISTOGRAM_LIMITS_US[HISTOGRAM_BINS - 1] = {250, 500, 1000, 2000, 4000, 8000, 16667};
+
+    uint32_t opcode_class[OPCODE_CLASSES] = {0};  ///< Instructions executed per opcode class
+    uint32_t dxyn_calls = 0;          ///< DXYN instructions executed
+    uint32_t frames_published = 0;    ///< Frames handed to the renderer
+    uint32_t frames_rendered = 0;     ///< Frames drawn to the display
+    uint32_t frames_skipped = 0;      ///< Frames dropped by frame pacing
+    uint32_t missed_deadlines = 0;    ///< 60Hz ticks processed late
+    uint32_t i2c_bytes = 0;           ///< Bytes sent to the display
+    uint32_t blocks_translated = 0;   ///< Basic blocks translated by the block cache
+    uint32_t block_flushes = 0;       ///< Block cache flushes caused by stores into translated code
+    uint64_t execute_cycles = 0;      ///< Cycles spent executing instructions
+    uint64_t render_cycles = 0;       ///< Cycles spent rendering frames
+    uint64_t callback_cycles = 0;     ///< Cycles spent in the sketch's loop callback
+    uint32_t frame_execute_hist[HISTOGRAM_BINS] = {0};  ///< Execution time per 60Hz frame
+    uint32_t frame_render_hist[HISTOGRAM_BINS] = {0};   ///< Time per rendered frame
+    uint64_t execute_fetch_stalls = 0;  ///< Instruction fetch stall cycles while executing (CHIP8_PERF_STALLS)
+    uint64_t execute_data_stalls = 0;   ///< Data stall cycles while executing
+    uint64_t render_fetch_stalls = 0;   ///< Instruction fetch stall cycles while rendering
+    uint64_t render_data_stalls = 0;    ///< Data stall cycles while rendering
+    uint32_t frame_stall_hist[HISTOGRAM_BINS] = {0};    ///< Execution stall time per 60Hz frame
+    uint32_t multiplier = 1;          ///< Current emulation speed multiplier (chip8_core::set_speed_multiplier())
+
+    /**
+     * @brief Provides access to the counters shared by all emulator components.
+     *
+     * @return Reference to the chip8_perf instance.
+     */
+    static chip8_perf& getInstance() {
+      static chip8_perf instance;
+      return instance;
+    }
+
+    // Stall cycle counts of the calling core; always zero without CHIP8_PERF_STALLS
+    struct stalls {
+      uint32_t fetch;  ///< Instruction fetch stalls (code in flash)
+      uint32_t data;   ///< Data stalls (tables and ROMs in flash, PSRAM)
+    };
+
+    // Reads the stall counters of the calling core, starting its performance monitor on the first call
+    static stalls read_stalls() {
+    #if CHIP8_PERF_STALLS
+      static bool started[portNUM_PROCESSORS] = {};
+      BaseType_t core = xPortGetCoreID();
+      if (!started[core]) {
+        xtensa_perfmon_stop();
+        xtensa_perfmon_init(0, XTPERF_CNT_I_STALL, CHIP8_PERF_FETCH_STALL_MASK, 0, -1);
+        xtensa_perfmon_init(1, XTPERF_CNT_D_STALL, CHIP8_PERF_DATA_STALL_MASK, 0, -1);
+        xtensa_perfmon_start();
+        started[core] = true;
+      }
+      return {xtensa_perfmon_value(0), xtensa_perfmon_value(1)};
+    #else
+      return {0, 0};
+    #endif
+    }
+
+    // Adds the cycles and stalls (since 'start') of one execution batch to the current frame
+    void add_execute(uint32_t cycles, const stalls& start) {
+      execute_cycles += cycles;
+      frame_execute_cycles += cycles;
+      stalls now = read_stalls();
+      execute_fetch_stalls += now.fetch - start.fetch;
+      execute_data_stalls += now.data - start.data;
+      frame_stall_cycles += (now.fetch - start.fetch) + (now.data - start.data);
+    }
+
+    // Closes the current 60Hz frame: bins its execution time and stalls and counts late ticks
+    void end_frame(uint32_t ticks) {
+      frame_execute_hist[bin(frame_execute_cycles)]++;
+      frame_execute_cycles = 0;
+    #if CHIP8_PERF_STALLS
+      frame_stall_hist[bin(frame_stall_cycles)]++;
+    #endif
+      frame_stall_cycles = 0;
+      if (ticks > 1) {
+        missed_deadlines += ticks - 1;
+      }
+    }
+
+    // Records one rendered frame that took 'cycles', with its stalls since 'start'
+    void add_render(uint32_t cycles, const stalls& start) {
+      render_cycles += cycles;
+      stalls now = read_stalls();
+      render_fetch_stalls += now.fetch - start.fetch;
+      render_data_stalls += now.data - start.data;
+      frame_render_hist[bin(cycles)]++;
+      frames_rendered++;
+    }
+
+    // Clears all counters; the speed multiplier is a setting and is kept
+    void reset() {
+      uint32_t current_multiplier = multiplier;
+      *this = chip8_perf();
+      multiplier = current_multiplier;
+    }
+
+    /**
+     * @brief Prints all counters in a human readable form.
+     *
+     * @param out Destination, typically Serial.
+     */
+    void report(Print& out) const {
+      uint32_t mhz = ESP.getCpuFreqMHz();
+      uint32_t instructions = 0;
+      for (uint8_t i = 0; i < 16; i++) {
+        instructions += opcode_class[i];
+      }
+      out.println(F("--- CHIP-8 performance ---"));
+      out.printf("instructions %lu  dxyn %lu  predecode misses %lu  speed x%lu\n",
+                 (unsigned long)instructions, (unsigned long)dxyn_calls,
+                 (unsigned long)opcode_class[16], (unsigned long)multiplier);
+      out.print(F("opcode classes"));
+      for (uint8_t i = 0; i < 16; i++) {
+        out.printf(" %X:%lu", i, (unsigned long)opcode_class[i]);
+      }
+      out.println();
+      out.printf("frames published %lu  rendered %lu  skipped %lu  missed deadlines %lu\n",
+                 (unsigned long)frames_published, (unsigned long)frames_rendered,
+                 (unsigned long)frames_skipped, (unsigned long)missed_deadlines);
+      out.printf("time ms: execute %lu  render %lu  callback %lu\n",
+                 (unsigned long)(execute_cycles / mhz / 1000), (unsigned long)(render_cycles / mhz / 1000),
+                 (unsigned long)(callback_cycles / mhz / 1000));
+      out.printf("i2c bytes %lu (%lu per rendered frame)\n", (unsigned long)i2c_bytes,
+                 (unsigned long)(frames_rendered ? i2c_bytes / frames_rendered : 0));
+      out.printf("blocks translated %lu  flushes %lu\n", (unsigned long)blocks_translated,
+                 (unsigned long)block_flushes);
+      print_histogram(out, "execute/frame", frame_execute_hist);
+      print_histogram(out, "render/frame ", frame_render_hist);
+    #if CHIP8_PERF_STALLS
+      out.printf("stall ms: execute fetch %lu data %lu  render fetch %lu data %lu\n",
+                 (unsigned long)(execute_fetch_stalls / mhz / 1000), (unsigned long)(execute_data_stalls / mhz / 1000),
+                 (unsigned long)(render_fetch_stalls / mhz / 1000), (unsigned long)(render_data_stalls / mhz / 1000));
+      print_histogram(out, "stalls/frame ", frame_stall_hist);
+    #endif
+    }
+
+  private:
+    uint32_t frame_execute_cycles = 0;  ///< Execution cycles of the frame in progress
+    uint32_t frame_stall_cycles = 0;    ///< Execution stall cycles of the frame in progress
+
+    // Returns the histogram bucket for a duration in cycles
+    static uint8_t bin(uint32_t cycles) {
+      uint32_t us = cycles / ESP.getCpuFreqMHz();
+      uint8_t i = 0;
+      while (i < HISTOGRAM_BINS - 1 && us >= HISTOGRAM_LIMITS_US[i]) {
+        i++;
+      }
+      return i;
+    }
+
+    static void print_histogram(Print& out, const char* name, const uint32_t* hist) {
+      out.print(name);
+      for (uint8_t i = 0; i < HISTOGRAM_BINS; i++) {
+        if (i < HISTOGRAM_BINS - 1) {
+          out.printf(" <%luus:%lu", (unsigned long)HISTOGRAM_LIMITS_US[i], (unsigned long)hist[i]);
+        } else {
+          out.printf(" more:%lu", (unsigned long)hist[i]);
+        }
+      }
+      out.println();
+    }
+};
+
+  #define CHIP8_PERF_COUNT(counter, n) (chip8_perf::getInstance().counter += (n))
+  #define CHIP8_PERF_SET(counter, value) (chip8_perf::getInstance().counter = (value))
+  #define CHIP8_PERF_OPCODE(cls) (chip8_perf::getInstance().opcode_class[(cls)]++)
+  #define CHIP8_PERF_BEGIN(name) const chip8_perf::stalls name##_stalls = chip8_perf::read_stalls(); \
+                                 uint32_t name##_start = ESP.getCycleCount()
+  #define CHIP8_PERF_EXECUTE_END(name) chip8_perf::getInstance().add_execute(ESP.getCycleCount() - name##_start, name##_stalls)
+  #define CHIP8_PERF_RENDER_END(name) chip8_perf::getInstance().add_render(ESP.getCycleCount() - name##_start, name##_stalls)
+  #define CHIP8_PERF_CALLBACK_END(name) ((void)name##_stalls, CHIP8_PERF_COUNT(callback_cycles, ESP.getCycleCount() - name##_start))
+  #define CHIP8_PERF_FRAME(ticks) chip8_perf::getInstance().end_frame(ticks)
+
+#else
+
+  #define CHIP8_PERF_COUNT(counter, n) ((void)0)
+  #define CHIP8_PERF_SET(counter, value) ((void)0)
+  #define CHIP8_PERF_OPCODE(cls) ((void)0)
+  #define CHIP8_PERF_BEGIN(name) ((void)0)
+  #define CHIP8_PERF_EXECUTE_END(name) ((void)0)
+  #define CHIP8_PERF_RENDER_END(name) ((void)0)
+  #define CHIP8_PERF_CALLBACK_END(name) ((void)0)
+  #define CHIP8_PERF_FRAME(ticks) ((void)0)
+
+#endif  // CHIP8_PERF
+
+#endif  // CHIP8_PERF_H
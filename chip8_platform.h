@@ -0,0 +1,95 @@
+#ifndef CHIP8_PLATFORM_H
+#define CHIP8_PLATFORM_H
+
+// Platform layer for the emulator core. On the ESP32 this is just Arduino.h; on a host
+// (no ARDUINO define) it provides the few Arduino/ESP-IDF pieces chip8_core uses, so the
+// interpreter can be built and benchmarked on a PC (see host/).
+
+#ifdef ARDUINO
+
+  #include <Arduino.h>
+
+#else
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <stdio.h>
+  #include <string.h>
+  #include <stdarg.h>
+  #include <atomic>
+  #include <algorithm>
+  #include <chrono>
+
+  using std::min;
+  using std::max;
+
+  #define IRAM_ATTR
+  #define DRAM_ATTR
+  #define F(str) (str)
+
+  // Virtual clock and random state of the host build
+  namespace chip8_host {
+    inline uint64_t clock_us = 0;             // Time seen by millis()/micros(), advanced by the harness
+    inline uint32_t random_state = 0x2545F491;  // xorshift32 state behind esp_random()
+
+    // Advances the virtual clock by 'us' microseconds
+    inline void advance_us(uint64_t us) {
+      clock_us += us;
+    }
+  }
+
+  inline unsigned long millis() {
+    return static_cast<unsigned long>(chip8_host::clock_us / 1000);
+  }
+
+  inline unsigned long micros() {
+    return static_cast<unsigned long>(chip8_host::clock_us);
+  }
+
+  // Deterministic stand-in for the ESP32 hardware RNG
+  inline uint32_t esp_random() {
+    uint32_t x = chip8_host::random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    chip8_host::random_state = x;
+    return x;
+  }
+
+  // Hardware timers do not exist on the host; the core falls back to millis()/micros()
+  struct hw_timer_t {};
+  inline hw_timer_t* timerBegin(uint32_t) { return nullptr; }
+  inline void timerAttachInterruptArg(hw_timer_t*, void (*)(void*), void*) {}
+  inline void timerAlarm(hw_timer_t*, uint64_t, bool, uint64_t) {}
+  inline void timerEnd(hw_timer_t*) {}
+
+  // Minimal Print writing to stdout, enough for chip8_perf::report()
+  class Print {
+    public:
+      size_t print(const char* str) { return fputs(str, stdout) < 0 ? 0 : strlen(str); }
+      size_t println(const char* str = "") { return print(str) + print("\n"); }
+      size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written < 0 ? 0 : written;
+      }
+  };
+
+  // Cycle counter of the host build: nanoseconds of a 1000MHz "CPU"
+  class EspClass {
+    public:
+      uint32_t getCycleCount() {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count());
+      }
+      uint32_t getCpuFreqMHz() { return 1000; }
+  };
+
+  inline Print Serial;
+  inline EspClass ESP;
+
+#endif  // ARDUINO
+
+#endif  // CHIP8_PLATFORM_H
@@ -0,0 +1,98 @@
+#ifndef DIRTY_MAP_H
+#define DIRTY_MAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @class dirty_map
+ * @brief Bit-packed record of which 8-pixel cells of the 64x32 display changed.
+ *
+ * A cell is one byte of the display buffer: row y (0-31), byte column c (0-7).
+ * `rows` has bit y set when any cell in row y is dirty and `cols[y]` has bit c set
+ * for each dirty cell in that row, so consumers can walk only the changed cells
+ * with __builtin_ctz. The union of all column masks is kept as well, which makes
+ * the dirty bounding rectangle an O(1) query. The whole map is 37 bytes.
+ */
+class dirty_map {
+  public:
+    uint32_t rows = 0;     ///< Bit y set if row y has at least one dirty cell
+    uint8_t cols[32] = {0};  ///< Per-row dirty cell mask, bit c = byte column c (0 = leftmost)
+    uint8_t col_union = 0;   ///< OR of all column masks
+
+    // Marks the cell at row 'y', byte column 'col' as dirty
+    void mark(uint8_t y, uint8_t col) {
+        mark_cells(y, static_cast<uint8_t>(1 << col));
+    }
+
+    // Marks every cell in 'mask' (bit c = byte column c) of row 'y' as dirty
+    void mark_cells(uint8_t y, uint8_t mask) {
+        rows |= static_cast<uint32_t>(1) << y;
+        cols[y] |= mask;
+        col_union |= mask;
+    }
+
+    // Marks the whole display as dirty
+    void mark_all() {
+        rows = 0xFFFFFFFF;
+        memset(cols, 0xFF, sizeof(cols));
+        col_union = 0xFF;
+    }
+
+    // Clears the map, touching only the rows that were dirty
+    void clear() {
+        uint32_t pending = rows;
+        while (pending) {
+            cols[__builtin_ctz(pending)] = 0;
+            pending &= pending - 1;
+        }
+        rows = 0;
+        col_union = 0;
+    }
+
+    // Adds all dirty cells of 'other' to this map
+    void merge(const dirty_map& other) {
+        uint32_t pending = other.rows;
+        while (pending) {
+            uint8_t y = __builtin_ctz(pending);
+            cols[y] |= other.cols[y];
+            pending &= pending - 1;
+        }
+        rows |= other.rows;
+        col_union |= other.col_union;
+    }
+
+    // Returns true if at least one cell is dirty
+    bool any() const {
+        return rows != 0;
+    }
+
+    // Retrieves the inclusive dirty bounding rectangle in cells; returns false if nothing is dirty
+    bool bounds(uint8_t& col_first, uint8_t& row_first, uint8_t& col_last, uint8_t& row_last) const {
+        if (rows == 0) {
+            return false;
+        }
+        row_first = __builtin_ctz(rows);
+        row_last = 31 - __builtin_clz(rows);
+        col_first = __builtin_ctz(col_union);
+        col_last = 31 - __builtin_clz(static_cast<uint32_t>(col_union));
+        return true;
+    }
+
+    // Calls 'fn(y, col)' for every dirty cell, top to bottom and left to right
+    template<typename F>
+    void for_each(F fn) const {
+        uint32_t pending_rows = rows;
+        while (pending_rows) {
+            uint8_t y = __builtin_ctz(pending_rows);
+            uint8_t pending_cols = cols[y];
+            while (pending_cols) {
+                fn(y, static_cast<uint8_t>(__builtin_ctz(pending_cols)));
+                pending_cols &= pending_cols - 1;
+            }
+            pending_rows &= pending_rows - 1;
+        }
+    }
+};
+
+#endif  // DIRTY_MAP_H
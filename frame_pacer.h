@@ -0,0 +1,84 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stdint.h>
+
+/**
+ * @class frame_pacer
+ * @brief Decides which published frames get rendered, based on a target rate and measured latency.
+ *
+ * Renders are scheduled against a deadline that advances by the pacing interval per
+ * render, so the rate holds on average even though frames arrive with jitter. A frame is
+ * rendered if it arrives no more than a quarter interval before the deadline; otherwise
+ * it is skipped (see chip8_core::skip_frame(), which merges its changes into the next
+ * frame). A deadline more than one interval behind is resynced to the render that missed
+ * it, so a stall is not caught up with a burst of renders. The interval is the larger of
+ * the target render period and the measured render latency scaled by the render budget,
+ * so a slow display automatically gets fewer frames instead of eating into CPU time.
+ * All timestamps are in microseconds (micros()).
+ */
+class frame_pacer {
+  private:
+    uint32_t target_interval_us = 1000000UL / 60;  ///< Minimum time between renders
+    uint8_t budget_percent = 50;      ///< Maximum share of wall time spent rendering
+    uint32_t latency_us = 0;          ///< Running average of the render latency
+    uint32_t next_render_us = 0;      ///< Deadline of the next render
+    bool has_rendered = false;        ///< False until the first frame was rendered
+    uint32_t rendered = 0;            ///< Frames rendered
+    uint32_t skipped = 0;             ///< Frames skipped
+
+  public:
+    // Sets the target render rate in frames per second (0 = no limit besides the budget)
+    void set_target_rate(uint8_t fps) {
+        target_interval_us = fps ? 1000000UL / fps : 0;
+    }
+
+    // Sets the share of wall time (1-100%) rendering may take; 100 disables latency feedback
+    void set_budget(uint8_t percent) {
+        budget_percent = (percent == 0 || percent > 100) ? 100 : percent;
+    }
+
+    // Returns the current pacing interval: target period or latency-derived minimum, whichever is longer
+    uint32_t interval_us() const {
+        uint32_t latency_interval = budget_percent < 100 ? latency_us * 100 / budget_percent : 0;
+        return latency_interval > target_interval_us ? latency_interval : target_interval_us;
+    }
+
+    // Returns true if a frame published at 'now_us' should be rendered; counts a skip otherwise
+    bool should_render(uint32_t now_us) {
+        // Signed difference: frames up to a quarter interval early count as on time
+        if (!has_rendered || static_cast<int32_t>(now_us - next_render_us) >= -static_cast<int32_t>(interval_us() / 4)) {
+            return true;
+        }
+        skipped++;
+        return false;
+    }
+
+    // Records a render that ran from 'start_us' to 'end_us' and feeds its latency back
+    void rendered_frame(uint32_t start_us, uint32_t end_us) {
+        uint32_t latency = end_us - start_us;
+        latency_us = has_rendered ? (latency_us * 7 + latency) / 8 : latency;  // 1/8 exponential average
+        uint32_t interval = interval_us();
+        if (has_rendered && static_cast<int32_t>(start_us - next_render_us) <= static_cast<int32_t>(interval)) {
+            next_render_us += interval;            // On schedule: keep the average rate
+        } else {
+            next_render_us = start_us + interval;  // First render or stalled: resync
+        }
+        has_rendered = true;
+        rendered++;
+    }
+
+    // Forgets measurements and counters, e.g. when a new game starts
+    void reset() {
+        latency_us = 0;
+        has_rendered = false;
+        rendered = 0;
+        skipped = 0;
+    }
+
+    uint32_t get_latency_us() const { return latency_us; }
+    uint32_t get_rendered() const { return rendered; }
+    uint32_t get_skipped() const { return skipped; }
+};
+
+#endif  // FRAME_PACER_H
@@ -0,0 +1,290 @@
+#ifndef FRAME_STREAMER_H
+#define FRAME_STREAMER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <atomic>
+#include "chip8_core.h"
+
+// Default UDP port of the receivers
+#ifndef STREAM_PORT
+  #define STREAM_PORT 8264
+#endif
+
+// A keyframe is sent every STREAM_KEYFRAME_INTERVAL packets, so late joiners and receivers that lost a packet resync
+#ifndef STREAM_KEYFRAME_INTERVAL
+  #define STREAM_KEYFRAME_INTERVAL 60
+#endif
+
+// Without new frames the last one is repeated as a keyframe after this many milliseconds
+#ifndef STREAM_IDLE_KEYFRAME_MS
+  #define STREAM_IDLE_KEYFRAME_MS 1000
+#endif
+
+// Sender task settings; Wi-Fi runs on core 0 as well
+#define STREAM_TASK_CORE 0
+#define STREAM_TASK_PRIORITY 1
+#define STREAM_TASK_STACK_SIZE 4096
+
+#define STREAM_MAGIC_0 'C'
+#define STREAM_MAGIC_1 '8'
+#define STREAM_VERSION 1
+#define STREAM_HEADER_SIZE 8
+#define STREAM_FRAME_BYTES ((32 * 64) / 8)         // 64x32 frame
+#define STREAM_HIRES_FRAME_BYTES ((64 * 128) / 8)  // SCHIP 128x64 frame
+
+// Packet type bits
+enum stream_packet_type : uint8_t {
+  STREAM_DELTA = 0,     // Payload is the XOR against the previous packet's frame
+  STREAM_KEYFRAME = 1,  // Payload is the frame itself (the XOR against an empty frame)
+  STREAM_HIRES = 2,     // 128x64 frame in SSD1306 page order; a mode change always sends a keyframe
+};
+
+/**
+ * @class frame_streamer
+ * @brief Sends the published CHIP-8 frames as small UDP packets, e.g. to a remote monitor or recorder.
+ *
+ * capture() is called with each rendered frame and its dirty map (see chip8::set_frame_callback())
+ * and only copies them; a task pinned to STREAM_TASK_CORE encodes and sends, so Wi-Fi latency
+ * never reaches the emulator loop. Frames captured while a send is in flight are merged into
+ * the next packet.
+ *
+ * Each packet holds one frame. A delta packet starts from the 256-byte XOR against the frame
+ * of the previous packet, built from the dirty cells only (all other cells are zero), and
+ * packs it with a zero-run RLE, so a typical frame needs a few dozen bytes instead of 256.
+ * Every STREAM_KEYFRAME_INTERVAL packets, and after STREAM_IDLE_KEYFRAME_MS without new
+ * frames, a keyframe carries the whole frame instead.
+ *
+ * Packet layout: 'C', '8', STREAM_VERSION, stream_packet_type bits, 32-bit little-endian
+ * sequence number, payload. Payload tokens: 0x80 | (n - 1) is a run of n zero bytes, n - 1
+ * (below 0x80) is followed by n literal bytes; they expand to exactly 256 bytes (row-major,
+ * 8 bytes per row, bit 7 = leftmost pixel), or 1024 bytes with STREAM_HIRES (8 pages of 128
+ * column bytes, bit 0 = top pixel). A receiver XORs a delta into its frame, replaces its
+ * frame with a keyframe, and ignores deltas after a gap in the sequence numbers until the
+ * next keyframe.
+ */
+class frame_streamer {
+  private:
+      WiFiUDP udp;
+      IPAddress host;                  // Receiver, or the subnet broadcast address
+      uint16_t port = STREAM_PORT;
+      uint16_t keyframe_interval = STREAM_KEYFRAME_INTERVAL;
+
+      TaskHandle_t task = nullptr;
+      std::atomic<bool> task_active{false};   // Cleared to ask the task to exit
+      std::atomic<bool> task_exited{false};   // Set by the task right before it exits
+
+      // Hand-off from capture() to the task, guarded by 'lock'
+      portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+      uint8_t pending_frame[STREAM_HIRES_FRAME_BYTES];
+      dirty_map pending_dirty;
+      bool pending_hires = false;
+      bool pending = false;
+
+      // Task only
+      uint8_t frame[STREAM_HIRES_FRAME_BYTES];      // Frame being sent
+      dirty_map dirty;                              // Its cells changed since the previous packet
+      bool frame_hires = false;                     // 'frame' is a 128x64 frame
+      uint8_t reference[STREAM_HIRES_FRAME_BYTES];  // Frame of the previous packet, as the receivers have it
+      bool reference_hires = false;
+      uint8_t delta[STREAM_HIRES_FRAME_BYTES];
+      uint8_t packet[STREAM_HEADER_SIZE + 2 * STREAM_HIRES_FRAME_BYTES];  // Every token covers at least one byte
+      bool has_reference = false;
+      uint32_t sequence = 0;                  // Sequence number of the next packet
+      uint16_t since_keyframe = 0;            // Packets sent since the last keyframe
+
+      // Statistics
+      uint32_t packets_sent = 0;
+      uint32_t keyframes_sent = 0;
+      uint32_t bytes_sent = 0;                // UDP payload bytes, headers included
+      uint32_t send_errors = 0;
+      uint32_t frames_merged = 0;             // Captures merged into a frame that was not sent yet
+      uint16_t last_packet_bytes = 0;
+
+      // Packs 'length' bytes of 'data' into RLE tokens at 'out'; returns the bytes written
+      static size_t encode_rle(const uint8_t* data, size_t length, uint8_t* out) {
+        uint8_t* start = out;
+        size_t i = 0;
+        while (i < length) {
+          size_t run = 0;
+          while (i + run < length && run < 128 && data[i + run] == 0) {
+            run++;
+          }
+          if (run > 0) {
+            *out++ = 0x80 | (run - 1);
+            i += run;
+            continue;
+          }
+          // Literals until the next pair of zeros; a single one is cheaper inline
+          uint8_t* token = out++;
+          while (i + run < length && run < 128) {
+            size_t k = i + run;
+            if (data[k] == 0 && k + 1 < length && data[k + 1] == 0) {
+              break;
+            }
+            *out++ = data[k];
+            run++;
+          }
+          *token = run - 1;
+          i += run;
+        }
+        return out - start;
+      }
+
+      // Encodes 'frame' as a keyframe or a delta against 'reference' and sends it
+      void send_frame(bool keyframe) {
+        const size_t frame_bytes = frame_hires ? STREAM_HIRES_FRAME_BYTES : STREAM_FRAME_BYTES;
+        keyframe |= frame_hires != reference_hires;
+        if (keyframe) {
+          memcpy(delta, frame, frame_bytes);
+        } else {
+          memset(delta, 0, frame_bytes);
+          bool changed = false;
+          dirty.for_each([&](uint8_t y, uint8_t col) {
+            // A 128x64 cell is marked in row 4 * page and covers 16 column bytes of that page
+            uint16_t first = frame_hires ? (y >> 2) * 128 + col * 16 : y * 8 + col;
+            uint16_t last = frame_hires ? first + 15 : first;
+            for (uint16_t index = first; index <= last; index++) {
+              delta[index] = frame[index] ^ reference[index];
+              changed |= delta[index] != 0;
+            }
+          });
+          if (!changed) {
+            return;  // Drawn and erased again; the receivers already show this frame
+          }
+        }
+        memcpy(reference, frame, frame_bytes);
+        reference_hires = frame_hires;
+        has_reference = true;
+
+        packet[0] = STREAM_MAGIC_0;
+        packet[1] = STREAM_MAGIC_1;
+        packet[2] = STREAM_VERSION;
+        packet[3] = (keyframe ? STREAM_KEYFRAME : STREAM_DELTA) | (frame_hires ? STREAM_HIRES : 0);
+        packet[4] = sequence & 0xFF;
+        packet[5] = (sequence >> 8) & 0xFF;
+        packet[6] = (sequence >> 16) & 0xFF;
+        packet[7] = sequence >> 24;
+        size_t length = STREAM_HEADER_SIZE + encode_rle(delta, frame_bytes, packet + STREAM_HEADER_SIZE);
+        sequence++;
+        since_keyframe = keyframe ? 0 : since_keyframe + 1;
+
+        if (udp.beginPacket(host, port) && udp.write(packet, length) == length && udp.endPacket()) {
+          packets_sent++;
+          keyframes_sent += keyframe ? 1 : 0;
+          bytes_sent += length;
+          last_packet_bytes = length;
+        } else {
+          send_errors++;  // Counted in the sequence anyway, so receivers notice the gap
+        }
+      }
+
+      /**
+       * @brief Task body: sends each captured frame, and a keyframe when the stream is idle.
+       */
+      static void task_main(void* arg) {
+        frame_streamer* self = static_cast<frame_streamer*>(arg);
+        while (self->task_active.load(std::memory_order_acquire)) {
+          bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(STREAM_IDLE_KEYFRAME_MS)) != 0;
+          portENTER_CRITICAL(&self->lock);
+          bool captured = self->pending;
+          if (captured) {
+            self->frame_hires = self->pending_hires;
+            memcpy(self->frame, self->pending_frame, self->frame_hires ? STREAM_HIRES_FRAME_BYTES : STREAM_FRAME_BYTES);
+            self->dirty.clear();
+            self->dirty.merge(self->pending_dirty);
+            self->pending_dirty.clear();
+            self->pending = false;
+          }
+          portEXIT_CRITICAL(&self->lock);
+          if (captured) {
+            self->send_frame(!self->has_reference || self->since_keyframe + 1 >= self->keyframe_interval);
+          } else if (!woken && self->has_reference) {
+            memcpy(self->frame, self->reference, sizeof(self->frame));  // Idle: repeat the last frame for late joiners
+            self->frame_hires = self->reference_hires;
+            self->send_frame(true);
+          }
+        }
+        self->task_exited.store(true, std::memory_order_release);
+        vTaskDelete(NULL);
+      }
+
+  public:
+  // Starts the sender task streaming to 'receiver'; Wi-Fi may still be connecting. False if the task could not be created
+  bool begin(const IPAddress& receiver, uint16_t receiver_port = STREAM_PORT) {
+    host = receiver;
+    port = receiver_port;
+    if (task != nullptr) {
+      return true;
+    }
+    has_reference = false;  // Start with a keyframe
+    portENTER_CRITICAL(&lock);
+    pending = false;
+    pending_dirty.clear();
+    portEXIT_CRITICAL(&lock);
+    task_exited.store(false, std::memory_order_relaxed);
+    task_active.store(true, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(task_main, "frame_stream", STREAM_TASK_STACK_SIZE, this,
+                                STREAM_TASK_PRIORITY, &task, STREAM_TASK_CORE) != pdPASS) {
+      task_active.store(false, std::memory_order_relaxed);
+      task = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  // Waits for the packet in flight, then stops the sender task
+  void end() {
+    if (task == nullptr) {
+      return;
+    }
+    task_active.store(false, std::memory_order_release);
+    xTaskNotifyGive(task);
+    while (!task_exited.load(std::memory_order_acquire)) {
+      vTaskDelay(1);
+    }
+    task = nullptr;
+    udp.stop();
+  }
+
+  // Queues a published frame and its changed cells for sending; only copies, never blocks on Wi-Fi
+  void capture(const uint8_t* published, bool hires, const dirty_map& changed) {
+    if (task == nullptr) {
+      return;
+    }
+    portENTER_CRITICAL(&lock);
+    if (pending) {
+      frames_merged++;
+    }
+    memcpy(pending_frame, published, hires ? STREAM_HIRES_FRAME_BYTES : STREAM_FRAME_BYTES);
+    pending_hires = hires;
+    pending_dirty.merge(changed);
+    pending = true;
+    portEXIT_CRITICAL(&lock);
+    xTaskNotifyGive(task);
+  }
+
+  // Frame callback for chip8::set_frame_callback(), 'arg' is the frame_streamer
+  static void on_frame(void* arg, const uint8_t* published, bool hires, const dirty_map& changed) {
+    static_cast<frame_streamer*>(arg)->capture(published, hires, changed);
+  }
+
+  // Sends a keyframe every 'packets' packets (at least 1, which sends only keyframes)
+  void set_keyframe_interval(uint16_t packets) {
+    keyframe_interval = packets > 0 ? packets : 1;
+  }
+
+  uint32_t get_packets_sent() const { return packets_sent; }
+  uint32_t get_bytes_sent() const { return bytes_sent; }
+  uint16_t get_last_packet_bytes() const { return last_packet_bytes; }
+
+  // Prints packet, keyframe and byte counts
+  void report(Print& out) const {
+    out.printf("stream: %lu packets (%lu key), %lu bytes (%lu per packet), %lu merged, %lu errors\n",
+               (unsigned long)packets_sent, (unsigned long)keyframes_sent, (unsigned long)bytes_sent,
+               (unsigned long)(packets_sent ? bytes_sent / packets_sent : 0), (unsigned long)frames_merged,
+               (unsigned long)send_errors);
+  }
+};
+#endif
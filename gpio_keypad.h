@@ -2,45 +2,153 @@
 #define GPIO_KEYPAD_H
 
 #include <Arduino.h>
+#include <atomic>
+#include "esp_timer.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
 #include "chip8_core.h"
 
 #define NUM_KEYS 16
-const uint8_t key_pins[16] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+#define KEY_PIN_UNUSED -1
+
+// Keypad scan period and the time the key state must be stable before it is published
+#define KEYPAD_SCAN_INTERVAL_US 1000
+#define KEYPAD_DEBOUNCE_US 5000
+
+// Define GPIO_KEYPAD_DEBUG to log key changes to Serial from handle_keys() (never from the scan itself)
+
+// GPIO pin of each CHIP-8 key 0x0-0xF, KEY_PIN_UNUSED if not connected; buttons connect to GND
+const int8_t key_pins[NUM_KEYS] = {
+  KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED,
+  KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED,
+  KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED,
+  KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED, KEY_PIN_UNUSED,
+};
+
+/**
+ * @class gpio_keypad
+ * @brief Debounced 16-key GPIO keypad feeding chip8_core.
+ *
+ * A scan reads all key pins with one register read per GPIO bank (GPIO_IN_REG, plus
+ * GPIO_IN1_REG for pins 32 and up) and turns them into a 16-bit key mask. The mask is
+ * published to chip8_core::set_key_mask() in one call once it has been stable for
+ * KEYPAD_DEBOUNCE_US, so bouncing contacts never reach the game.
+ *
+ * After begin_scan() the scan runs every KEYPAD_SCAN_INTERVAL_US from an esp_timer and
+ * the emulator loop does not spend any time on input. Without it handle_keys() scans
+ * on every call instead, as before.
+ */
 class gpio_keypad{
   private:
-      const unsigned long DEBOUNCE_DELAY = 50; // milliseconds
-      unsigned long last_debounce_time[NUM_KEYS] = {0};
-      bool last_key_state[NUM_KEYS] = {false};
+      chip8_core* core = &chip8_core::getInstance();  // Emulator receiving the keys
+      uint32_t bank0_mask = 0;        // Key pins in GPIO 0-31
+      uint32_t bank1_mask = 0;        // Key pins in GPIO 32 and up
+      uint16_t raw_keys = 0;          // Mask seen by the last scan
+      uint16_t stable_keys = 0;       // Debounced mask, last value published
+      int64_t last_change_us = 0;     // Time raw_keys last changed
+      esp_timer_handle_t scan_timer = nullptr;
+      std::atomic<uint16_t> changed_keys{0};  // Keys changed since the last debug log
+
+      // Reads all key pins and returns the pressed keys as a mask (bit k = key k)
+      uint16_t read_keys() {
+        uint32_t bank0 = ~REG_READ(GPIO_IN_REG) & bank0_mask;  // Pressed keys read LOW
+      #if SOC_GPIO_PIN_COUNT > 32
+        uint32_t bank1 = ~REG_READ(GPIO_IN1_REG) & bank1_mask;
+      #else
+        uint32_t bank1 = 0;
+      #endif
+        uint16_t keys = 0;
+        for (uint8_t key = 0; key < NUM_KEYS; key++) {
+          int8_t pin = key_pins[key];
+          if (pin == KEY_PIN_UNUSED) continue;
+          uint32_t bits = pin < 32 ? bank0 >> pin : bank1 >> (pin - 32);
+          keys |= (bits & 1) << key;
+        }
+        return keys;
+      }
+
+      // Samples the keys and publishes the mask once it has been stable long enough
+      void scan() {
+        int64_t now = esp_timer_get_time();
+        uint16_t keys = read_keys();
+        if (keys != raw_keys) {
+          raw_keys = keys;
+          last_change_us = now;
+        } else if (keys != stable_keys && now - last_change_us >= KEYPAD_DEBOUNCE_US) {
+          changed_keys.fetch_or(keys ^ stable_keys, std::memory_order_relaxed);
+          stable_keys = keys;
+          core->set_key_mask(keys);
+        }
+      }
+
+      static void scan_timer_callback(void* arg) {
+        static_cast<gpio_keypad*>(arg)->scan();
+      }
+
   public:
+  // Selects the emulator instance that receives the keys (default: chip8_core::getInstance())
+  void bind(chip8_core& instance) {
+    core = &instance;
+  }
+
   void setup(){
+    bank0_mask = 0;
+    bank1_mask = 0;
     for(uint8_t i = 0; i < NUM_KEYS; i++) {
-      if(key_pins[i] != (uint8_t)-1) { // Check if the pin is valid
+      if(key_pins[i] != KEY_PIN_UNUSED) { // Check if the pin is valid
         pinMode(key_pins[i], INPUT_PULLUP); // Assuming buttons connect to GND when pressed
-        last_debounce_time[i] = 0;
-        delay(100);
+        if (key_pins[i] < 32) {
+          bank0_mask |= 1UL << key_pins[i];
+        } else {
+          bank1_mask |= 1UL << (key_pins[i] - 32);
+        }
       }
     }
+    delay(100);  // Let the pull-ups settle
+  }
+
+  // Starts scanning from an esp_timer; returns false if the timer could not be created
+  bool begin_scan() {
+    if (scan_timer != nullptr) {
+      return true;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback = &scan_timer_callback;
+    args.arg = this;
+    args.name = "gpio_keypad";
+    if (esp_timer_create(&args, &scan_timer) != ESP_OK) {
+      scan_timer = nullptr;
+      return false;
+    }
+    esp_timer_start_periodic(scan_timer, KEYPAD_SCAN_INTERVAL_US);
+    return true;
+  }
+
+  // Stops timer scanning
+  void end_scan() {
+    if (scan_timer != nullptr) {
+      esp_timer_stop(scan_timer);
+      esp_timer_delete(scan_timer);
+      scan_timer = nullptr;
+    }
   }
+
+  // Scans the keys unless the timer does, and prints queued debug output
   void handle_keys() {
-    unsigned long current_time = millis();
-    for (uint8_t key = 0; key < NUM_KEYS; key++) {
-      if(key_pins[key] == (uint8_t)-1) continue; // Skip invalid pins
-      bool reading = (digitalRead(key_pins[key]) == LOW); // Assuming LOW when pressed
-      if (reading != last_key_state[key]) {
-        last_debounce_time[key] = current_time;
-      }
-      if ((current_time - last_debounce_time[key]) > DEBOUNCE_DELAY) {
-        if (reading != chip8_core::getInstance().is_key_pressed(key)) {
-          chip8_core::getInstance().set_key_state(key, reading);
-          // Optional: Debugging output
-          Serial.print("Key ");
-          Serial.print(key, HEX);
-          Serial.print(reading ? " pressed" : " released");
-          Serial.println();
-        }
-      }
-      last_key_state[key] = reading;  
+    if (scan_timer == nullptr) {
+      scan();
+    }
+  #ifdef GPIO_KEYPAD_DEBUG
+    uint16_t changed = changed_keys.exchange(0, std::memory_order_relaxed);
+    while (changed) {
+      uint8_t key = __builtin_ctz(changed);
+      Serial.print("Key ");
+      Serial.print(key, HEX);
+      Serial.print(core->is_key_pressed(key) ? " pressed" : " released");
+      Serial.println();
+      changed &= changed - 1;
     }
+  #endif
   }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,91 @@
+// Headless benchmark of chip8_core on the host.
+//
+// Runs the suite of bench_roms.h (synthetic microbenchmarks, then the shipped games; the same
+// ROMs as the on-device benchmark) for a fixed number of instructions in batched mode, driving
+// the virtual clock one 60Hz frame at a time and pressing keys in a fixed pattern, and
+// reports instructions/s, DXYN throughput and a checksum over all published frames.
+// The checksum only depends on the instructions executed, so it must not change when
+// the interpreter or the sprite blit is optimized.
+//
+// Usage: chip8_bench [million instructions per ROM (default 10)] [instructions per frame (default 1000)]
+
+#include "bench_roms.h"
+
+#include <stdlib.h>
+
+#if !CHIP8_PERF
+  #error "chip8_bench needs the performance counters, build with -DCHIP8_PERF=1"
+#endif
+
+// 64-bit FNV-1a over 'size' bytes, continuing from 'hash'
+static uint64_t fnv1a(const uint8_t* data, size_t size, uint64_t hash) {
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Instructions actually executed; idle loops skipped by the core are not counted
+static uint64_t executed_instructions(const chip8_perf& perf) {
+  uint64_t total = 0;
+  for (uint8_t i = 0; i < 16; i++) {
+    total += perf.opcode_class[i];
+  }
+  return total;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  double millions = argc > 1 ? atof(argv[1]) : 10.0;
+  uint16_t ipf = argc > 2 ? static_cast<uint16_t>(atoi(argv[2])) : 1000;
+  if (millions <= 0 || ipf == CPU_IPF_LEGACY || ipf == CPU_IPF_UNLIMITED) {
+    fprintf(stderr, "usage: %s [million instructions > 0] [instructions per frame 1-65534]\n", argv[0]);
+    return 1;
+  }
+  uint64_t target = static_cast<uint64_t>(millions * 1000000.0);
+
+  chip8_core& chip8 = chip8_core::getInstance();
+  chip8_perf& perf = chip8_perf::getInstance();
+  printf("%-15s %12s %10s %12s %12s %10s  %s\n", "rom", "instructions", "seconds", "instr/s", "dxyn/s", "frames", "frame hash");
+
+  for (const bench_rom& rom : BENCH_ROMS) {
+    chip8_host::clock_us = 0;
+    chip8_host::random_state = 0x2545F491;
+    chip8.stop();
+    chip8.set_quirks(rom.quirks);
+    chip8.load_rom(rom.data, rom.size);
+    chip8.set_instructions_per_frame(ipf);
+    chip8.start();
+    perf.reset();
+
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t executed = 0;
+    uint32_t frame = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (executed < target && chip8.is_running()) {
+      // Hold each key for half a second, cycling through all 16 keys
+      for (uint8_t key = 0; key < 16; key++) {
+        chip8.set_key_state(key, key == (frame / 60) % 16 && (frame % 60) < 30);
+      }
+      chip8_host::advance_us(GPU_TIMER_INTERVAL_US);
+      chip8.loop();
+      if (chip8.need_to_draw()) {
+        hash = fnv1a(chip8.get_display_buffer(), chip8.is_hires() ? 1024 : 256, hash);
+        chip8.reset_draw();
+      }
+      executed = executed_instructions(perf);
+      frame++;
+    }
+    double elapsed = seconds_since(start);
+
+    printf("%-15s %12llu %10.3f %12.0f %12.0f %10lu  %016llx%s\n", rom.name,
+           static_cast<unsigned long long>(executed), elapsed, executed / elapsed,
+           perf.dxyn_calls / elapsed, static_cast<unsigned long>(frame),
+           static_cast<unsigned long long>(hash), chip8.is_running() ? "" : " (ROM exited)");
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+// Host test of the DXYN row blitter: random sprites are drawn by the core and by a
+// per-pixel reference of the original DXYN loop, and the display bytes, VF and the
+// dirty cells of the published frame must match.
+//
+// Usage: dxyn_test [cases]
+
+#include "chip8_core.h"
+
+#include <stdlib.h>
+
+// Display, VF and dirty cells of the reference
+struct reference_frame {
+  uint8_t display[256] = {0};
+  uint8_t dirty[32] = {0};  // Bit c of dirty[y] = byte column c of row y
+  uint8_t vf = 0;
+};
+
+// Per-pixel DXYN of the original implementation: every set sprite bit toggles one pixel
+static void reference_draw(reference_frame& frame, uint8_t vx, uint8_t vy, const uint8_t* sprite, uint8_t height) {
+  frame.vf = 0;
+  for (uint8_t yline = 0; yline < height; yline++) {
+    uint8_t y_coord = (vy + yline) & 31;
+    for (uint8_t xline = 0; xline < 8; xline++) {
+      if (sprite[yline] & (0x80 >> xline)) {
+        uint8_t x_coord = (vx + xline) & 63;
+        uint16_t bit_index = x_coord + y_coord * 64;
+        uint8_t& byte = frame.display[bit_index >> 3];
+        uint8_t bit = 0x80 >> (bit_index & 7);
+        if (byte & bit) {
+          frame.vf = 1;
+        }
+        byte ^= bit;
+        frame.dirty[y_coord] |= 1 << (x_coord / 8);
+      }
+    }
+  }
+}
+
+// xorshift32, so every run tests the same cases
+static uint32_t next_random(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+int main(int argc, char** argv) {
+  uint32_t cases = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+  uint32_t state = 0x2545F491;
+  chip8_core& chip8 = chip8_core::getInstance();
+
+  for (uint32_t n = 0; n < cases; n++) {
+    // Two sprites; every other case draws the second one next to the first so they collide
+    uint8_t vx[2], vy[2], height[2];
+    uint8_t sprites[2][15];
+    for (uint8_t s = 0; s < 2; s++) {
+      vx[s] = next_random(state);
+      vy[s] = next_random(state);
+      height[s] = next_random(state) % 16;
+      for (uint8_t& row : sprites[s]) {
+        row = next_random(state);
+      }
+    }
+    if (n & 1) {
+      vx[1] = vx[0] + next_random(state) % 9 - 4;
+      vy[1] = vy[0] + next_random(state) % 9 - 4;
+    }
+
+    // An empty DRW that publishes the cleared display of the ROM start in a frame of its own,
+    // then LD V0, x; LD V1, y; LD I, sprite; DRW V0, V1, n for both sprites and JP to itself
+    uint8_t rom[0x120] = {
+        0xD0, 0x10,
+        0x60, vx[0], 0x61, vy[0], 0xA3, 0x00, 0xD0, static_cast<uint8_t>(0x10 | height[0]),
+        0x60, vx[1], 0x61, vy[1], 0xA3, 0x10, 0xD0, static_cast<uint8_t>(0x10 | height[1]),
+        0x12, 0x12,
+    };
+    memcpy(rom + 0x100, sprites[0], sizeof(sprites[0]));
+    memcpy(rom + 0x110, sprites[1], sizeof(sprites[1]));
+
+    chip8.stop();
+    chip8.load_rom(rom, sizeof(rom));
+    chip8.start();
+    chip8.step_frame(1);
+    chip8.get_dirty_map().clear();
+    chip8.reset_draw();
+    chip8.step_frame(12);
+
+    reference_frame expected;
+    reference_draw(expected, vx[0], vy[0], sprites[0], height[0]);
+    reference_draw(expected, vx[1], vy[1], sprites[1], height[1]);
+
+    static chip8_snapshot snap;
+    chip8.snapshot(snap);
+    const dirty_map& dirty = chip8.get_dirty_map();
+    const char* failure = nullptr;
+    if (memcmp(chip8.get_display_buffer(), expected.display, sizeof(expected.display)) != 0) {
+      failure = "display";
+    } else if (snap.registers.V[0xF] != expected.vf) {
+      failure = "VF";
+    } else if (memcmp(dirty.cols, expected.dirty, sizeof(expected.dirty)) != 0) {
+      failure = "dirty cells";
+    }
+    if (failure != nullptr) {
+      fprintf(stderr, "case %lu: %s differs (N=%u at %u,%u then N=%u at %u,%u)\n", static_cast<unsigned long>(n),
+              failure, height[0], vx[0], vy[0], height[1], vx[1], vy[1]);
+      return 1;
+    }
+    chip8.reset_draw();
+  }
+
+  printf("dxyn: %lu random sprite pairs match the per-pixel reference\n", static_cast<unsigned long>(cases));
+  return 0;
+}
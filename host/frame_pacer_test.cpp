@@ -0,0 +1,57 @@
+// Host test of frame_pacer: frames published with jitter around the render interval must
+// all be rendered, and a lower target rate must still be held on average.
+//
+// Usage: frame_pacer_test
+
+#include "frame_pacer.h"
+
+#include <stdio.h>
+
+static const uint32_t FRAMES = 3600;       // One minute at 60Hz
+static const uint32_t PERIOD_US = 16666;   // Publish period of the core
+static const uint32_t JITTER_US = 500;     // Maximum deviation of a publish from its slot
+static const uint32_t RENDER_US = 3000;    // Simulated render latency
+
+// Deterministic jitter in [-JITTER_US, JITTER_US]
+static int32_t jitter(uint32_t& state) {
+  state = state * 1103515245 + 12345;
+  return static_cast<int32_t>((state >> 16) % (2 * JITTER_US + 1)) - static_cast<int32_t>(JITTER_US);
+}
+
+// Publishes FRAMES frames at PERIOD_US with jitter and returns how many were rendered
+static uint32_t run(frame_pacer& pacer) {
+  uint32_t state = 1;
+  for (uint32_t frame = 0; frame < FRAMES; frame++) {
+    uint32_t now = 1000000 + frame * PERIOD_US + jitter(state);
+    if (pacer.should_render(now)) {
+      pacer.rendered_frame(now, now + RENDER_US);
+    }
+  }
+  return pacer.get_rendered();
+}
+
+int main() {
+  int failures = 0;
+
+  frame_pacer full;
+  run(full);
+  if (full.get_skipped() != 0) {
+    fprintf(stderr, "60fps: %lu of %lu frames skipped, expected none\n",
+            static_cast<unsigned long>(full.get_skipped()), static_cast<unsigned long>(FRAMES));
+    failures++;
+  }
+
+  frame_pacer half;
+  half.set_target_rate(30);
+  uint32_t rendered = run(half);
+  if (rendered < FRAMES / 2 - 1 || rendered > FRAMES / 2 + 1) {
+    fprintf(stderr, "30fps: %lu of %lu frames rendered, expected %lu\n", static_cast<unsigned long>(rendered),
+            static_cast<unsigned long>(FRAMES), static_cast<unsigned long>(FRAMES / 2));
+    failures++;
+  }
+
+  if (failures == 0) {
+    printf("frame_pacer: %lu jittered frames paced\n", static_cast<unsigned long>(FRAMES));
+  }
+  return failures ? 1 : 0;
+}
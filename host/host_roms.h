@@ -0,0 +1,102 @@
+#ifndef HOST_ROMS_H
+#define HOST_ROMS_H
+
+#include "chip8_core.h"
+#include "roms.h"
+
+#include <string.h>
+
+// Quirk test: runs each instruction a quirk profile changes once, keeping the results in
+// registers and I, then jumps with BNNN to an idle loop that depends on jump_vx; played
+// back under every profile by make check (traces/quirk_test_*.trace)
+const uint8_t quirk_test[84] = {
+    0x60, 0x0F,  // 200: LD V0, 0F
+    0x61, 0xF0,  // 202: LD V1, F0
+    0x6F, 0x01,  // 204: LD VF, 1
+    0x80, 0x11,  // 206: OR V0, V1      VF = 0 with vf_reset
+    0x8B, 0xF0,  // 208: LD VB, VF
+    0x6F, 0x01,  // 20A: LD VF, 1
+    0x80, 0x12,  // 20C: AND V0, V1
+    0x8C, 0xF0,  // 20E: LD VC, VF
+    0x6F, 0x01,  // 210: LD VF, 1
+    0x80, 0x13,  // 212: XOR V0, V1
+    0x8D, 0xF0,  // 214: LD VD, VF
+    0x65, 0x81,  // 216: LD V5, 81
+    0x66, 0x02,  // 218: LD V6, 02
+    0x85, 0x66,  // 21A: SHR V5, V6     V5 = 40, VF = 1; shift_vy: V5 = 01, VF = 0
+    0x87, 0xF0,  // 21C: LD V7, VF
+    0x68, 0x81,  // 21E: LD V8, 81
+    0x69, 0x40,  // 220: LD V9, 40
+    0x88, 0x9E,  // 222: SHL V8, V9     V8 = 02, VF = 1; shift_vy: V8 = 80, VF = 0
+    0x8A, 0xF0,  // 224: LD VA, VF
+    0xA3, 0x00,  // 226: LD I, 300
+    0xF1, 0x55,  // 228: LD [I], V1     I = 302 with memory_increment
+    0xF0, 0x65,  // 22A: LD V0, [I]     I = 303 with memory_increment
+    0x60, 0x00,  // 22C: LD V0, 0
+    0x62, 0x10,  // 22E: LD V2, 10
+    0xB2, 0x40,  // 230: JP V0, 240     jump_vx: JP 240 + V2 = 250
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0x6E, 0x01,  // 240: LD VE, 1
+    0x12, 0x42,  // 242: JP 242
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0x6E, 0x02,  // 250: LD VE, 2
+    0x12, 0x52,  // 252: JP 252
+};
+
+// SCHIP 128x64 test: 00FF, 16x16 DXY0 and 8xN sprites clipped at the right and bottom
+// edges, then a loop of 00CN/00FB/00FC scrolls with a moving 16x16 sprite (traces/hires_test.trace)
+const uint8_t hires_test[102] = {
+    0x00, 0xFF,  // 200: HIGH
+    0xA2, 0x40,  // 202: LD I, 240
+    0x60, 0x78,  // 204: LD V0, 78
+    0x61, 0x38,  // 206: LD V1, 38
+    0xD0, 0x10,  // 208: DRW V0, V1, 0   16x16 at 120,56: clipped at the right and bottom
+    0x60, 0x3C,  // 20A: LD V0, 3C
+    0x61, 0x14,  // 20C: LD V1, 14
+    0xD0, 0x10,  // 20E: DRW V0, V1, 0   16x16 at 60,20
+    0xA2, 0x60,  // 210: LD I, 260
+    0x62, 0xFE,  // 212: LD V2, FE
+    0x63, 0x7E,  // 214: LD V3, 7E
+    0xD2, 0x36,  // 216: DRW V2, V3, 6   8x6 at 126,62 after wrapping the start: clipped
+    0x00, 0xC3,  // 218: SCD 3
+    0x00, 0xFB,  // 21A: SCR
+    0x00, 0xFC,  // 21C: SCL
+    0x00, 0xFC,  // 21E: SCL
+    0xA2, 0x40,  // 220: LD I, 240
+    0x70, 0x0B,  // 222: ADD V0, 0B
+    0x71, 0x05,  // 224: ADD V1, 05
+    0xD0, 0x10,  // 226: DRW V0, V1, 0   wraps the start, clipped when near an edge
+    0x12, 0x18,  // 228: JP 218
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xFF, 0xFF, 0x80, 0x01, 0xBF, 0xFD, 0xA0, 0x05,  // 240: 16x16 sprite
+    0xA7, 0xE5, 0xA4, 0x25, 0xA5, 0xA5, 0xA5, 0xA5,
+    0xA5, 0xA5, 0xA4, 0x25, 0xA7, 0xE5, 0xA0, 0x05,
+    0xBF, 0xFD, 0x80, 0x01, 0xFF, 0xFF, 0x55, 0x55,
+    0x3C, 0x42, 0xA5, 0x81, 0x5A, 0x3C,              // 260: 8x6 sprite
+};
+
+// ROMs from roms.h (and the host test ROMs above) by name, shared by the host tools
+struct host_rom {
+  const char* name;
+  const uint8_t* data;
+  size_t size;
+};
+
+static const host_rom HOST_ROMS[] = {
+  {"space_invaders", space_invaders, sizeof(space_invaders)},
+  {"glitch_ghost", glitch_ghost, sizeof(glitch_ghost)},
+  {"quirk_test", quirk_test, sizeof(quirk_test)},
+  {"hires_test", hires_test, sizeof(hires_test)},
+};
+
+// Returns the ROM called 'name', or nullptr if there is none
+static inline const host_rom* find_host_rom(const char* name) {
+  for (const host_rom& rom : HOST_ROMS) {
+    if (strcmp(rom.name, name) == 0) {
+      return &rom;
+    }
+  }
+  return nullptr;
+}
+
+#endif  // HOST_ROMS_H
@@ -0,0 +1,194 @@
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include "chip8_core.h"
+
+// Bytes of delta storage; 32KB holds at least 10 seconds of a typical game at the default interval
+#ifndef REWIND_BUFFER_BYTES
+  #define REWIND_BUFFER_BYTES 32768
+#endif
+
+// Time between two rewind points in milliseconds
+#ifndef REWIND_INTERVAL_MS
+  #define REWIND_INTERVAL_MS 100
+#endif
+
+/**
+ * @class rewind_buffer
+ * @brief Ring buffer of delta-compressed chip8_core snapshots for rewinding a game.
+ *
+ * Only the newest snapshot is kept in full. Every older rewind point is stored as the
+ * XOR of two consecutive snapshots, which is almost all zeros because RAM and the display
+ * change little in a tenth of a second, packed with a zero-run RLE. The first step back
+ * restores the newest snapshot; each further step XORs the newest delta into it first. When the ring is full the oldest
+ * deltas are dropped, so memory use is fixed at REWIND_BUFFER_BYTES plus two snapshots
+ * (about 43KB by default) no matter how long the game runs.
+ *
+ * Record layout in the ring: 16-bit payload length, payload, 16-bit payload length again,
+ * so records can be dropped from the oldest end and popped from the newest end. Payload
+ * tokens: 0x80 | (n - 1) is a run of n zero bytes, n - 1 (below 0x80) is followed by n
+ * literal bytes.
+ */
+class rewind_buffer {
+  public:
+    // Captures a rewind point if REWIND_INTERVAL_MS passed since the last one; call once per loop
+    void update(chip8_core& core) {
+      uint32_t now = millis();
+      if (has_current && now - last_capture_ms < REWIND_INTERVAL_MS) {
+        return;
+      }
+      last_capture_ms = now;
+      capture(core);
+    }
+
+    // Captures a rewind point now
+    void capture(chip8_core& core) {
+      core.snapshot(scratch);
+      if (has_current) {
+        push_delta();
+      }
+      memcpy(&current, &scratch, sizeof(chip8_snapshot));
+      has_current = true;
+      at_current = false;
+    }
+
+    // Steps back to the previous rewind point; returns false if there is none left
+    bool rewind(chip8_core& core) {
+      if (!has_current || (at_current && count == 0)) {
+        return false;
+      }
+      if (at_current) {
+        pop_delta();  // Already at the newest point: go to the one before it
+      }
+      at_current = true;
+      last_capture_ms = millis();
+      return core.restore(current);
+    }
+
+    // Forgets all rewind points, e.g. when a new game starts
+    void clear() {
+      head = 0;
+      tail = 0;
+      used = 0;
+      count = 0;
+      has_current = false;
+      at_current = false;
+    }
+
+    uint16_t get_points() const { return count + (has_current ? 1 : 0); }  // Rewind points available
+    uint32_t get_seconds() const { return static_cast<uint32_t>(count) * REWIND_INTERVAL_MS / 1000; }  // History length
+    size_t get_used() const { return used; }                                // Delta bytes in use
+    size_t get_capacity() const { return sizeof(ring); }                   // Delta budget
+
+    // Prints budget, fill level and history length
+    void report(Print& out) const {
+      out.printf("rewind: %u points, %lus, %lu of %lu bytes (%lu per point)\n",
+                 (unsigned)get_points(), (unsigned long)get_seconds(), (unsigned long)used,
+                 (unsigned long)sizeof(ring), (unsigned long)(count ? used / count : 0));
+    }
+
+  private:
+    static constexpr size_t RECORD_OVERHEAD = 4;  // Leading and trailing length
+    // Worst case payload: all literals, one token per 128 bytes
+    static constexpr size_t MAX_PAYLOAD = sizeof(chip8_snapshot) + (sizeof(chip8_snapshot) + 127) / 128;
+    static_assert(REWIND_BUFFER_BYTES >= MAX_PAYLOAD + RECORD_OVERHEAD, "REWIND_BUFFER_BYTES too small for one snapshot");
+
+    uint8_t ring[REWIND_BUFFER_BYTES];
+    size_t head = 0;                // Write position, end of the newest record
+    size_t tail = 0;                // Start of the oldest record
+    size_t used = 0;                // Bytes between tail and head
+    uint16_t count = 0;             // Records in the ring
+    bool has_current = false;       // 'current' holds a snapshot
+    bool at_current = false;        // The core was restored to 'current' and has not been captured since
+    uint32_t last_capture_ms = 0;
+    chip8_snapshot current;         // Newest rewind point, in full
+    chip8_snapshot scratch;         // Snapshot being captured
+
+    uint8_t read_byte(size_t pos) const { return ring[pos % sizeof(ring)]; }
+    void write_byte(size_t pos, uint8_t value) { ring[pos % sizeof(ring)] = value; }
+
+    uint16_t read_length(size_t pos) const {
+      return read_byte(pos) | (read_byte(pos + 1) << 8);
+    }
+
+    void write_length(size_t pos, uint16_t length) {
+      write_byte(pos, length & 0xFF);
+      write_byte(pos + 1, length >> 8);
+    }
+
+    // Encodes current XOR scratch as a new record, dropping the oldest records to make room
+    void push_delta() {
+      const uint8_t* older = reinterpret_cast<const uint8_t*>(&current);
+      const uint8_t* newer = reinterpret_cast<const uint8_t*>(&scratch);
+      while (sizeof(ring) - used < MAX_PAYLOAD + RECORD_OVERHEAD) {
+        drop_oldest();
+      }
+
+      size_t start = head;
+      size_t pos = head + 2;
+      size_t i = 0;
+      while (i < sizeof(chip8_snapshot)) {
+        size_t run = 0;
+        while (i + run < sizeof(chip8_snapshot) && run < 128 && older[i + run] == newer[i + run]) {
+          run++;
+        }
+        if (run > 0) {
+          write_byte(pos++, 0x80 | (run - 1));
+          i += run;
+          continue;
+        }
+        // Literals until the next pair of unchanged bytes; a single one is cheaper inline
+        size_t token = pos++;
+        while (i + run < sizeof(chip8_snapshot) && run < 128) {
+          size_t k = i + run;
+          if (older[k] == newer[k] && k + 1 < sizeof(chip8_snapshot) && older[k + 1] == newer[k + 1]) {
+            break;
+          }
+          write_byte(pos++, older[k] ^ newer[k]);
+          run++;
+        }
+        write_byte(token, run - 1);
+        i += run;
+      }
+
+      uint16_t length = pos - start - 2;
+      write_length(start, length);
+      write_length(pos, length);
+      head = (pos + 2) % sizeof(ring);
+      used += length + RECORD_OVERHEAD;
+      count++;
+    }
+
+    // Removes the newest record and XORs it into current, which becomes the previous point
+    void pop_delta() {
+      size_t end = head + sizeof(ring);  // Keeps the arithmetic below non-negative
+      uint16_t length = read_length(end - 2);
+      size_t start = end - 2 - length - 2;
+      uint8_t* data = reinterpret_cast<uint8_t*>(&current);
+      size_t pos = start + 2;
+      size_t i = 0;
+      while (pos < end - 2) {
+        uint8_t token = read_byte(pos++);
+        size_t run = (token & 0x7F) + 1;
+        if (token & 0x80) {
+          i += run;
+        } else {
+          for (size_t k = 0; k < run; k++) {
+            data[i++] ^= read_byte(pos++);
+          }
+        }
+      }
+      head = start % sizeof(ring);
+      used -= length + RECORD_OVERHEAD;
+      count--;
+    }
+
+    void drop_oldest() {
+      uint16_t length = read_length(tail);
+      tail = (tail + length + RECORD_OVERHEAD) % sizeof(ring);
+      used -= length + RECORD_OVERHEAD;
+      count--;
+    }
+};
+
+#endif  // REWIND_BUFFER_H
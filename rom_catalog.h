@@ -0,0 +1,190 @@
+#ifndef ROM_CATALOG_H
+#define ROM_CATALOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <Preferences.h>
+#include "chip8_core.h"
+
+// Directory scanned for ROM files
+#ifndef ROM_CATALOG_DIR
+  #define ROM_CATALOG_DIR "/roms"
+#endif
+
+// NVS namespace holding the index; bump ROM_CATALOG_VERSION when rom_entry changes
+#define ROM_CATALOG_NAMESPACE "rom_catalog"
+#define ROM_CATALOG_VERSION 1
+
+#define ROM_NAME_LENGTH 31  // Longest display name kept
+#define ROM_FILE_LENGTH 31  // Longest file name accepted
+
+// Quirk hints, derived from the file extension
+enum rom_hint : uint8_t {
+  ROM_HINT_CHIP8 = 0,   // .ch8: original CHIP-8
+  ROM_HINT_SCHIP = 1,   // .sc8: SUPER-CHIP
+  ROM_HINT_XOCHIP = 2,  // .xo8: XO-CHIP
+};
+
+// One ROM of the catalog, stored as one NVS blob
+struct rom_entry {
+  char name[ROM_NAME_LENGTH + 1];  // Display name: file name without extension, '_' as space
+  char file[ROM_FILE_LENGTH + 1];  // File name in ROM_CATALOG_DIR
+  uint16_t size;                   // ROM size in bytes
+  uint8_t hint;                    // rom_hint
+};
+
+/**
+ * @class rom_catalog
+ * @brief Index of the ROM files on a LittleFS or SD volume, cached in NVS.
+ *
+ * begin() scans ROM_CATALOG_DIR once and stores one small rom_entry per ROM in NVS,
+ * together with a fingerprint of the volume. Later boots with an unchanged fingerprint
+ * use the stored index without touching the directory. Only the entry asked for is
+ * ever held in RAM, and load() streams the ROM file straight into chip8_core memory,
+ * so RAM use and startup time do not grow with the number of ROMs.
+ *
+ * The fingerprint combines the directory's modification time with a volume stamp
+ * from the caller (the volume's used bytes, e.g. LittleFS.usedBytes()). On LittleFS,
+ * getLastWrite() of a directory is 0 unless the core is built with
+ * CONFIG_LITTLEFS_USE_MTIME, so there the fingerprint only depends on usedBytes().
+ * Call rescan() after changing the ROMs in a way neither would notice, such as
+ * replacing a ROM with one that occupies the same number of blocks.
+ */
+class rom_catalog {
+  private:
+      fs::FS* fs = nullptr;
+      Preferences nvs;
+      uint16_t rom_count = 0;
+
+      // Key of entry 'index' in NVS, "r<index>"
+      static void entry_key(uint16_t index, char* key) {
+        snprintf(key, 8, "r%u", (unsigned)index);
+      }
+
+      // Returns the quirk hint of a file name, or false if it is not a ROM
+      static bool file_hint(const char* file, uint8_t& hint) {
+        const char* ext = strrchr(file, '.');
+        if (ext == nullptr) return false;
+        if (strcasecmp(ext, ".ch8") == 0) { hint = ROM_HINT_CHIP8; return true; }
+        if (strcasecmp(ext, ".sc8") == 0) { hint = ROM_HINT_SCHIP; return true; }
+        if (strcasecmp(ext, ".xo8") == 0) { hint = ROM_HINT_XOCHIP; return true; }
+        return false;
+      }
+
+      // Display name of a file: without extension, underscores as spaces
+      static void display_name(const char* file, char* name) {
+        size_t length = strrchr(file, '.') - file;
+        if (length > ROM_NAME_LENGTH) length = ROM_NAME_LENGTH;
+        for (size_t i = 0; i < length; i++) {
+          name[i] = file[i] == '_' ? ' ' : file[i];
+        }
+        name[length] = '\0';
+      }
+
+      uint32_t fingerprint(uint64_t volume_stamp) {
+        File dir = fs->open(ROM_CATALOG_DIR);
+        uint32_t modified = dir ? static_cast<uint32_t>(dir.getLastWrite()) : 0;
+        dir.close();
+        return modified ^ static_cast<uint32_t>(volume_stamp) ^ static_cast<uint32_t>(volume_stamp >> 32) ^
+               (ROM_CATALOG_VERSION << 24);
+      }
+
+      static size_t read_file(void* arg, uint8_t* buffer, size_t length) {
+        return static_cast<File*>(arg)->read(buffer, length);
+      }
+
+  public:
+  // Opens the index, scanning ROM_CATALOG_DIR on 'volume' if the fingerprint changed; false if NVS failed
+  bool begin(fs::FS& volume, uint64_t volume_stamp) {
+    fs = &volume;
+    if (!nvs.begin(ROM_CATALOG_NAMESPACE, false)) {
+      return false;
+    }
+    uint32_t current = fingerprint(volume_stamp);
+    if (nvs.isKey("count") && nvs.getULong("fp", 0) == current) {
+      rom_count = nvs.getUShort("count", 0);
+    } else {
+      rescan();
+      nvs.putULong("fp", current);
+    }
+    return true;
+  }
+
+  // Rebuilds the index from ROM_CATALOG_DIR
+  void rescan() {
+    uint16_t old_count = nvs.getUShort("count", 0);
+    rom_count = 0;
+    char key[8];
+    File dir = fs->open(ROM_CATALOG_DIR);
+    if (dir && dir.isDirectory()) {
+      for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        rom_entry entry = {};
+        const char* file_name = file.name();
+        if (file.isDirectory() || strlen(file_name) > ROM_FILE_LENGTH || !file_hint(file_name, entry.hint) ||
+            file.size() == 0 || file.size() > 4096 - 0x200) {
+          file.close();
+          continue;
+        }
+        strcpy(entry.file, file_name);
+        display_name(file_name, entry.name);
+        entry.size = file.size();
+        file.close();
+        entry_key(rom_count++, key);
+        nvs.putBytes(key, &entry, sizeof(entry));
+      }
+    }
+    dir.close();
+    for (uint16_t i = rom_count; i < old_count; i++) {  // Drop entries of removed ROMs
+      entry_key(i, key);
+      nvs.remove(key);
+    }
+    nvs.putUShort("count", rom_count);
+  }
+
+  // Number of ROMs in the catalog
+  uint16_t count() const {
+    return rom_count;
+  }
+
+  // Reads entry 'index'; returns false if there is no such entry
+  bool get(uint16_t index, rom_entry& entry) {
+    if (index >= rom_count) {
+      return false;
+    }
+    char key[8];
+    entry_key(index, key);
+    return nvs.getBytes(key, &entry, sizeof(entry)) == sizeof(entry);
+  }
+
+  // Quirk profile for a hint; plain .ch8 files run with the emulator's default behavior
+  static chip8_quirk_profile hint_quirks(uint8_t hint) {
+    switch (hint) {
+      case ROM_HINT_SCHIP: return CHIP8_QUIRKS_SCHIP;
+      case ROM_HINT_XOCHIP: return CHIP8_QUIRKS_XOCHIP;
+      default: return CHIP8_QUIRKS_LEGACY;
+    }
+  }
+
+  // Streams ROM 'index' into 'core' and selects its quirk profile; start it with chip8::play_game(nullptr, ...) or chip8_core::start()
+  bool load(uint16_t index, chip8_core& core) {
+    rom_entry entry;
+    if (!get(index, entry)) {
+      return false;
+    }
+    core.set_quirks(hint_quirks(entry.hint));
+    char path[sizeof(ROM_CATALOG_DIR) + 1 + ROM_FILE_LENGTH + 1];
+    snprintf(path, sizeof(path), "%s/%s", ROM_CATALOG_DIR, entry.file);
+    File file = fs->open(path, "r");
+    if (!file) {
+      return false;
+    }
+    bool loaded = core.load_rom(&read_file, &file, entry.size);
+    file.close();
+    return loaded;
+  }
+
+  void end() {
+    nvs.end();
+  }
+};
+#endif
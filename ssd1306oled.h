@@ -8,47 +8,293 @@
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET -1
+#define OLED_I2C_CLOCK 400000UL  // I2C clock used for all transfers, including partial pushes
 
+// Default number of dirty data bytes above which a frame is pushed in full
+#define OLED_PARTIAL_THRESHOLD 768
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+// Largest data payload per I2C transaction (one byte of the Wire buffer holds the control byte)
+#ifdef I2C_BUFFER_LENGTH
+  #define OLED_I2C_CHUNK (I2C_BUFFER_LENGTH - 1)
+#else
+  #define OLED_I2C_CHUNK 31
+#endif
+
+// Background flush task settings for asynchronous mode
+#define OLED_FLUSH_TASK_CORE 0
+#define OLED_FLUSH_TASK_PRIORITY 2
+#define OLED_FLUSH_TASK_STACK_SIZE 3072
+
+// Keep the bus at OLED_I2C_CLOCK after Adafruit transactions so partial pushes run at full speed too
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, OLED_I2C_CLOCK, OLED_I2C_CLOCK);
+
+/**
+ * @brief Expands two vertically adjacent 4-pixel CHIP-8 row fragments into 2x-scaled page bytes.
+ *
+ * Index bits 0-3 hold the upper row's nibble and bits 4-7 the lower row's nibble
+ * (bit 3 / bit 7 = leftmost pixel). Byte k of the result is the SSD1306 column byte
+ * for the k-th pixel: bits 0-1 are the upper row doubled vertically, bits 2-3 the
+ * lower row. Shifting a result left by 4 places it in the bottom half of a page.
+ */
+static CHIP8_HOT_DATA constexpr uint32_t PAGE_LUT[256] = {
+    0x00000000, 0x03000000, 0x00030000, 0x03030000, 0x00000300, 0x03000300, 0x00030300, 0x03030300,
+    0x00000003, 0x03000003, 0x00030003, 0x03030003, 0x00000303, 0x03000303, 0x00030303, 0x03030303,
+    0x0C000000, 0x0F000000, 0x0C030000, 0x0F030000, 0x0C000300, 0x0F000300, 0x0C030300, 0x0F030300,
+    0x0C000003, 0x0F000003, 0x0C030003, 0x0F030003, 0x0C000303, 0x0F000303, 0x0C030303, 0x0F030303,
+    0x000C0000, 0x030C0000, 0x000F0000, 0x030F0000, 0x000C0300, 0x030C0300, 0x000F0300, 0x030F0300,
+    0x000C0003, 0x030C0003, 0x000F0003, 0x030F0003, 0x000C0303, 0x030C0303, 0x000F0303, 0x030F0303,
+    0x0C0C0000, 0x0F0C0000, 0x0C0F0000, 0x0F0F0000, 0x0C0C0300, 0x0F0C0300, 0x0C0F0300, 0x0F0F0300,
+    0x0C0C0003, 0x0F0C0003, 0x0C0F0003, 0x0F0F0003, 0x0C0C0303, 0x0F0C0303, 0x0C0F0303, 0x0F0F0303,
+    0x00000C00, 0x03000C00, 0x00030C00, 0x03030C00, 0x00000F00, 0x03000F00, 0x00030F00, 0x03030F00,
+    0x00000C03, 0x03000C03, 0x00030C03, 0x03030C03, 0x00000F03, 0x03000F03, 0x00030F03, 0x03030F03,
+    0x0C000C00, 0x0F000C00, 0x0C030C00, 0x0F030C00, 0x0C000F00, 0x0F000F00, 0x0C030F00, 0x0F030F00,
+    0x0C000C03, 0x0F000C03, 0x0C030C03, 0x0F030C03, 0x0C000F03, 0x0F000F03, 0x0C030F03, 0x0F030F03,
+    0x000C0C00, 0x030C0C00, 0x000F0C00, 0x030F0C00, 0x000C0F00, 0x030C0F00, 0x000F0F00, 0x030F0F00,
+    0x000C0C03, 0x030C0C03, 0x000F0C03, 0x030F0C03, 0x000C0F03, 0x030C0F03, 0x000F0F03, 0x030F0F03,
+    0x0C0C0C00, 0x0F0C0C00, 0x0C0F0C00, 0x0F0F0C00, 0x0C0C0F00, 0x0F0C0F00, 0x0C0F0F00, 0x0F0F0F00,
+    0x0C0C0C03, 0x0F0C0C03, 0x0C0F0C03, 0x0F0F0C03, 0x0C0C0F03, 0x0F0C0F03, 0x0C0F0F03, 0x0F0F0F03,
+    0x0000000C, 0x0300000C, 0x0003000C, 0x0303000C, 0x0000030C, 0x0300030C, 0x0003030C, 0x0303030C,
+    0x0000000F, 0x0300000F, 0x0003000F, 0x0303000F, 0x0000030F, 0x0300030F, 0x0003030F, 0x0303030F,
+    0x0C00000C, 0x0F00000C, 0x0C03000C, 0x0F03000C, 0x0C00030C, 0x0F00030C, 0x0C03030C, 0x0F03030C,
+    0x0C00000F, 0x0F00000F, 0x0C03000F, 0x0F03000F, 0x0C00030F, 0x0F00030F, 0x0C03030F, 0x0F03030F,
+    0x000C000C, 0x030C000C, 0x000F000C, 0x030F000C, 0x000C030C, 0x030C030C, 0x000F030C, 0x030F030C,
+    0x000C000F, 0x030C000F, 0x000F000F, 0x030F000F, 0x000C030F, 0x030C030F, 0x000F030F, 0x030F030F,
+    0x0C0C000C, 0x0F0C000C, 0x0C0F000C, 0x0F0F000C, 0x0C0C030C, 0x0F0C030C, 0x0C0F030C, 0x0F0F030C,
+    0x0C0C000F, 0x0F0C000F, 0x0C0F000F, 0x0F0F000F, 0x0C0C030F, 0x0F0C030F, 0x0C0F030F, 0x0F0F030F,
+    0x00000C0C, 0x03000C0C, 0x00030C0C, 0x03030C0C, 0x00000F0C, 0x03000F0C, 0x00030F0C, 0x03030F0C,
+    0x00000C0F, 0x03000C0F, 0x00030C0F, 0x03030C0F, 0x00000F0F, 0x03000F0F, 0x00030F0F, 0x03030F0F,
+    0x0C000C0C, 0x0F000C0C, 0x0C030C0C, 0x0F030C0C, 0x0C000F0C, 0x0F000F0C, 0x0C030F0C, 0x0F030F0C,
+    0x0C000C0F, 0x0F000C0F, 0x0C030C0F, 0x0F030C0F, 0x0C000F0F, 0x0F000F0F, 0x0C030F0F, 0x0F030F0F,
+    0x000C0C0C, 0x030C0C0C, 0x000F0C0C, 0x030F0C0C, 0x000C0F0C, 0x030C0F0C, 0x000F0F0C, 0x030F0F0C,
+    0x000C0C0F, 0x030C0C0F, 0x000F0C0F, 0x030F0C0F, 0x000C0F0F, 0x030C0F0F, 0x000F0F0F, 0x030F0F0F,
+    0x0C0C0C0C, 0x0F0C0C0C, 0x0C0F0C0C, 0x0F0F0C0C, 0x0C0C0F0C, 0x0F0C0F0C, 0x0C0F0F0C, 0x0F0F0F0C,
+    0x0C0C0C0F, 0x0F0C0C0F, 0x0C0F0C0F, 0x0F0F0C0F, 0x0C0C0F0F, 0x0F0C0F0F, 0x0C0F0F0F, 0x0F0F0F0F
+};
 
 class ssd1306oled{
   private:
+    /**
+     * @brief Converts one dirty cell column of a page straight into the SSD1306 buffer.
+     *
+     * SSD1306 page p covers display rows 8p-8p+7, i.e. CHIP-8 rows 4p-4p+3. The four
+     * source bytes of byte column `byte_index` become 16 column bytes (8 pixels, each
+     * doubled horizontally) with four table lookups.
+     */
+    static CHIP8_HOT void convert_cell(uint8_t* page_buffer, const uint8_t* source, uint8_t page, uint8_t byte_index) {
+      const uint8_t* row = source + page * 32 + byte_index;  // 4 CHIP-8 rows of 8 bytes per page
+      uint8_t a = row[0], b = row[8], c = row[16], d = row[24];
+      uint32_t left = PAGE_LUT[(a >> 4) | (b & 0xF0)] | (PAGE_LUT[(c >> 4) | (d & 0xF0)] << 4);
+      uint32_t right = PAGE_LUT[(a & 0x0F) | (b << 4 & 0xF0)] | (PAGE_LUT[(c & 0x0F) | (d << 4 & 0xF0)] << 4);
+      uint8_t* out = page_buffer + page * SCREEN_WIDTH + byte_index * 16;
+      for (uint8_t k = 0; k < 4; k++) {
+        out[k * 2] = out[k * 2 + 1] = left >> (k * 8);
+        out[8 + k * 2] = out[9 + k * 2] = right >> (k * 8);
+      }
+    }
+
+    /**
+     * @brief Column window of one SSD1306 page that has to be sent; empty if first > last.
+     */
+    struct page_window {
+      uint8_t first;  ///< First display column (0-127)
+      uint8_t last;   ///< Last display column (0-127)
+    };
+
+    chip8_core* core = &chip8_core::getInstance();    ///< Emulator whose frames are drawn
+    uint8_t i2c_address = 0x3C;                       ///< I2C address passed to setup()
+    uint16_t partial_threshold = OLED_PARTIAL_THRESHOLD;  ///< Dirty data bytes above which the full frame is pushed
+    page_window windows[8];                           ///< Dirty column window per page of the current frame
+    uint32_t last_frame_bytes = 0;                    ///< Bytes sent over I2C for the last frame
+    uint32_t total_bytes = 0;                         ///< Bytes sent over I2C since setup()
+    uint32_t frames_drawn = 0;                        ///< Frames pushed since setup()
+
+    // Asynchronous flush: frames are converted in the caller and pushed by a background task
+    TaskHandle_t flush_task = nullptr;                ///< Background flush task, if async mode is active
+    std::atomic<bool> flush_busy{false};              ///< Set while the flush task owns flush_buffer
+    std::atomic<bool> flush_task_active{false};       ///< Cleared to ask the flush task to exit
+    std::atomic<bool> flush_task_exited{false};       ///< Set by the flush task right before it exits
+    bool flush_pending = false;                       ///< Converted changes not yet handed to the flush task
+    page_window pending_windows[8];                   ///< Union of windows converted since the last hand-off
+    page_window flush_windows[8];                     ///< Windows the flush task is sending
+    bool flush_full = false;                          ///< The flush task sends the whole frame
+    uint8_t flush_buffer[SCREEN_WIDTH * SCREEN_HEIGHT / 8];  ///< Snapshot of the page buffer being sent
+
+    /**
+     * @brief Converts all dirty cells into the SSD1306 buffer and records each page's column window.
+     *
+     * A 128x64 SCHIP frame already is in page order and needs no conversion; only the
+     * windows are recorded, and the frame is pushed straight from the core's buffer.
+     *
+     * @return Number of data bytes covered by the page windows.
+     */
+    CHIP8_HOT uint16_t convert_dirty() {
+      dirty_map& dirty = core->get_dirty_map();  // Cells changed since the last draw
+      const uint8_t* source = core->get_display_buffer();
+      uint8_t* page_buffer = display.getBuffer();
+      const bool native = core->is_hires();
+      uint16_t dirty_bytes = 0;
+      for (uint8_t page = 0; page < 8; page++) {
+        uint8_t shift = page * 4;
+        windows[page] = {1, 0};
+        if (((dirty.rows >> shift) & 0x0F) == 0) {
+          continue;  // None of this page's four CHIP-8 rows changed
+        }
+        uint8_t cols = dirty.cols[shift] | dirty.cols[shift + 1] | dirty.cols[shift + 2] | dirty.cols[shift + 3];
+        windows[page].first = __builtin_ctz(cols) * 16;
+        windows[page].last = (31 - __builtin_clz(static_cast<uint32_t>(cols))) * 16 + 15;
+        dirty_bytes += windows[page].last - windows[page].first + 1;
+        while (cols && !native) {
+          convert_cell(page_buffer, source, page, __builtin_ctz(cols));
+          cols &= cols - 1;
+        }
+      }
+      dirty.clear();  // Clear the dirty cells after updating
+      return dirty_bytes;
+    }
+
+    /**
+     * @brief Sends one rectangular window of the page buffer.
+     *
+     * The column (0x21) and page (0x22) address commands restrict the controller to the
+     * window; with horizontal addressing it then consumes the data row by row of pages.
+     *
+     * @return Number of bytes sent, including command and control bytes.
+     */
+    uint32_t push_window(const uint8_t* page_buffer, uint8_t first_page, uint8_t last_page, uint8_t first_col, uint8_t last_col) {
+      Wire.beginTransmission(i2c_address);
+      Wire.write((uint8_t)0x00);  // Control byte: command stream
+      Wire.write((uint8_t)SSD1306_COLUMNADDR);
+      Wire.write(first_col);
+      Wire.write(last_col);
+      Wire.write((uint8_t)SSD1306_PAGEADDR);
+      Wire.write(first_page);
+      Wire.write(last_page);
+      Wire.endTransmission();
+      uint32_t sent = 7;
+
+      uint16_t width = last_col - first_col + 1;
+      for (uint8_t page = first_page; page <= last_page; page++) {
+        const uint8_t* data = page_buffer + page * SCREEN_WIDTH + first_col;
+        uint16_t remaining = width;
+        while (remaining) {
+          uint16_t chunk = remaining < OLED_I2C_CHUNK ? remaining : OLED_I2C_CHUNK;
+          Wire.beginTransmission(i2c_address);
+          Wire.write((uint8_t)0x40);  // Control byte: data stream
+          Wire.write(data, chunk);
+          Wire.endTransmission();
+          sent += chunk + 1;
+          data += chunk;
+          remaining -= chunk;
+        }
+      }
+      return sent;
+    }
+
+    /**
+     * @brief Sends either the whole frame or only the given page windows.
+     *
+     * @return Number of bytes sent, including command and control bytes.
+     */
+    uint32_t push(const uint8_t* page_buffer, const page_window* page_windows, bool full) {
+      if (full) {
+        return push_window(page_buffer, 0, 7, 0, SCREEN_WIDTH - 1);
+      }
+      uint32_t sent = 0;
+      for (uint8_t page = 0; page < 8; page++) {
+        if (page_windows[page].first <= page_windows[page].last) {
+          sent += push_window(page_buffer, page, page, page_windows[page].first, page_windows[page].last);
+        }
+      }
+      return sent;
+    }
+
+    /**
+     * @brief Returns the number of data bytes covered by a set of page windows.
+     */
+    static uint16_t window_bytes(const page_window* page_windows) {
+      uint16_t bytes = 0;
+      for (uint8_t page = 0; page < 8; page++) {
+        if (page_windows[page].first <= page_windows[page].last) {
+          bytes += page_windows[page].last - page_windows[page].first + 1;
+        }
+      }
+      return bytes;
+    }
+
     void draw_oled() {
-      uint8_t (*dirty_flags)[8] = chip8_core::getInstance().get_dirty_flags();  // Access dirty flags array
-      for (uint8_t y = 0; y < 32; y++) {
-        for (uint8_t byte_index = 0; byte_index < 8; byte_index++) {
-          if (dirty_flags[y][byte_index]) {  // Only update if marked dirty
-            for (uint8_t bit = 0; bit < 8; bit++) {
-              uint8_t x = byte_index * 8 + bit;
-              uint16_t bit_index = x + y * 64;
-              uint16_t buffer_byte_index = bit_index >> 3;
-              uint8_t display_bit = 7 - (bit_index & 0x07);
-              // Check if pixel should be on or off
-              if (chip8_core::getInstance().get_display_buffer()[buffer_byte_index] & (1 << display_bit)) {
-                uint8_t display_x = x * 2;
-                uint8_t display_y = y * 2;
-                // Draw a 2x2 white square to represent an active CHIP-8 pixel
-                display.drawPixel(display_x, display_y, SSD1306_WHITE);
-                display.drawPixel(display_x + 1, display_y, SSD1306_WHITE);
-                display.drawPixel(display_x, display_y + 1, SSD1306_WHITE);
-                display.drawPixel(display_x + 1, display_y + 1, SSD1306_WHITE);
-              } 
-              else {
-            
-                uint8_t display_x = x * 2;
-                uint8_t display_y = y * 2;
-                display.drawPixel(display_x, display_y, SSD1306_BLACK);
-                display.drawPixel(display_x + 1, display_y, SSD1306_BLACK);
-                display.drawPixel(display_x, display_y + 1, SSD1306_BLACK);
-                display.drawPixel(display_x + 1, display_y + 1, SSD1306_BLACK);
-              }
-            }
-            dirty_flags[y][byte_index] = 0;  // Clear the dirty flag after updating
-          }
+      uint16_t dirty_bytes = convert_dirty();
+      const uint8_t* page_buffer = core->is_hires() ? core->get_display_buffer() : display.getBuffer();
+      // Cheaper to push the whole frame than many windows above the threshold
+      last_frame_bytes = push(page_buffer, windows, dirty_bytes > partial_threshold);
+      total_bytes += last_frame_bytes;
+      frames_drawn++;
+      CHIP8_PERF_COUNT(i2c_bytes, last_frame_bytes);
+    }
+
+    /**
+     * @brief Converts a published frame and merges its windows into the pending hand-off.
+     */
+    CHIP8_HOT void convert_pending() {
+      if (!flush_pending) {
+        for (uint8_t page = 0; page < 8; page++) {
+          pending_windows[page] = {1, 0};
+        }
+      }
+      convert_dirty();
+      const bool native = core->is_hires();
+      for (uint8_t page = 0; page < 8; page++) {
+        if (windows[page].first > windows[page].last) {
+          continue;
+        }
+        if (native) {
+          // The flush task sends from the page buffer: copy the window of the core's frame there
+          uint16_t offset = page * SCREEN_WIDTH + windows[page].first;
+          memcpy(display.getBuffer() + offset, core->get_display_buffer() + offset,
+                 windows[page].last - windows[page].first + 1);
+        }
+        if (pending_windows[page].first > pending_windows[page].last) {
+          pending_windows[page] = windows[page];
+        } else {
+          pending_windows[page].first = min(pending_windows[page].first, windows[page].first);
+          pending_windows[page].last = max(pending_windows[page].last, windows[page].last);
+        }
+      }
+      flush_pending = true;
+    }
+
+    /**
+     * @brief Snapshots the page buffer and pending windows and wakes the flush task.
+     *
+     * Only called while flush_busy is clear, so the task is not reading flush_buffer.
+     */
+    void start_flush() {
+      memcpy(flush_buffer, display.getBuffer(), sizeof(flush_buffer));
+      memcpy(flush_windows, pending_windows, sizeof(flush_windows));
+      flush_full = window_bytes(pending_windows) > partial_threshold;
+      flush_pending = false;
+      flush_busy.store(true, std::memory_order_release);
+      xTaskNotifyGive(flush_task);
+    }
+
+    /**
+     * @brief Flush task body: sends each snapshot handed over by start_flush().
+     *
+     * @param arg Pointer to the owning ssd1306oled instance.
+     */
+    static void flush_task_main(void* arg) {
+      ssd1306oled* self = static_cast<ssd1306oled*>(arg);
+      while (self->flush_task_active.load(std::memory_order_acquire)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->flush_busy.load(std::memory_order_acquire)) {
+          self->last_frame_bytes = self->push(self->flush_buffer, self->flush_windows, self->flush_full);
+          self->total_bytes += self->last_frame_bytes;
+          self->frames_drawn++;
+          CHIP8_PERF_COUNT(i2c_bytes, self->last_frame_bytes);
+          self->flush_busy.store(false, std::memory_order_release);
         }
       }
-      display.display();  // Push the update to the OLED
+      self->flush_task_exited.store(true, std::memory_order_release);
+      vTaskDelete(NULL);
     }
   public:
     #ifdef SSD1306OLED
@@ -64,11 +310,21 @@ class ssd1306oled{
       return display;
     }
     #endif
+
+    /**
+     * @brief Selects the emulator instance whose frames are drawn (default: chip8_core::getInstance()).
+     *
+     * @param instance Emulator to draw; must not change while a game is running.
+     */
+    void bind(chip8_core& instance) {
+      core = &instance;
+    }
     
     bool setup(uint16_t OledAddress = 0x3C){
       if(!display.begin(SSD1306_SWITCHCAPVCC, OledAddress)) { 
         return false;
       }
+      i2c_address = OledAddress;
       delay(500);
       display.clearDisplay();
       display.display();
@@ -77,10 +333,112 @@ class ssd1306oled{
     }
 
     void draw(){
-      if (chip8_core::getInstance().need_to_draw()) {
+      if (flush_task != nullptr) {
+        // Asynchronous mode: convert right away, hand the result over once the bus is free
+        if (core->need_to_draw()) {
+          convert_pending();
+          core->reset_draw();
+        }
+        if (flush_pending && !flush_busy.load(std::memory_order_acquire)) {
+          start_flush();
+        }
+        return;
+      }
+      if (core->need_to_draw()) {
         draw_oled();
-        chip8_core::getInstance().reset_draw(); 
+        core->reset_draw(); 
+      }
+    }
+
+    /**
+     * @brief Starts asynchronous flushing with a background task pinned to OLED_FLUSH_TASK_CORE.
+     *
+     * draw() then only converts frames (microseconds) and the I2C transfer of a snapshot of
+     * the page buffer runs in the task, so the caller can keep executing instructions.
+     * Frames converted while a transfer is in flight are merged into the next one.
+     *
+     * @return True if async mode is active.
+     */
+    bool begin_async_flush() {
+      if (flush_task != nullptr) {
+        return true;
       }
+      flush_pending = false;
+      flush_busy.store(false, std::memory_order_relaxed);
+      flush_task_exited.store(false, std::memory_order_relaxed);
+      flush_task_active.store(true, std::memory_order_release);
+      if (xTaskCreatePinnedToCore(flush_task_main, "oled_flush", OLED_FLUSH_TASK_STACK_SIZE, this,
+                                  OLED_FLUSH_TASK_PRIORITY, &flush_task, OLED_FLUSH_TASK_CORE) != pdPASS) {
+        flush_task_active.store(false, std::memory_order_relaxed);
+        flush_task = nullptr;
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * @brief Waits for the transfer in flight, then stops the flush task.
+     *
+     * Changes converted but not yet sent are pushed synchronously, so the panel always
+     * ends up showing the last frame and the display can be used directly afterwards.
+     */
+    void end_async_flush() {
+      if (flush_task == nullptr) {
+        return;
+      }
+      while (!flush_done()) {
+        vTaskDelay(1);
+      }
+      flush_task_active.store(false, std::memory_order_release);
+      xTaskNotifyGive(flush_task);
+      while (!flush_task_exited.load(std::memory_order_acquire)) {
+        vTaskDelay(1);
+      }
+      flush_task = nullptr;
+      if (flush_pending) {
+        last_frame_bytes = push(display.getBuffer(), pending_windows, window_bytes(pending_windows) > partial_threshold);
+        total_bytes += last_frame_bytes;
+        frames_drawn++;
+        CHIP8_PERF_COUNT(i2c_bytes, last_frame_bytes);
+        flush_pending = false;
+      }
+    }
+
+    /**
+     * @brief Returns true if no asynchronous transfer is in flight.
+     */
+    bool flush_done() const {
+      return !flush_busy.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Sets the number of dirty data bytes above which a frame is pushed in full.
+     *
+     * @param bytes Threshold in bytes (0 always pushes full frames, 1024 never does).
+     */
+    void set_partial_threshold(uint16_t bytes) {
+      partial_threshold = bytes;
+    }
+
+    /**
+     * @brief Returns the number of bytes sent over I2C for the last drawn frame.
+     */
+    uint32_t get_last_frame_bytes() const {
+      return last_frame_bytes;
+    }
+
+    /**
+     * @brief Returns the number of bytes sent over I2C since setup().
+     */
+    uint32_t get_total_bytes() const {
+      return total_bytes;
+    }
+
+    /**
+     * @brief Returns the number of frames pushed since setup().
+     */
+    uint32_t get_frames_drawn() const {
+      return frames_drawn;
     }
 };
 